@@ -1,10 +1,12 @@
 // vector_add.cu — C[i] = A[i] + B[i]
 // Identical logic to glsl/vector_add.comp for 1:1 SASS comparison.
+// Grid-stride loop over 64-bit indices: any grid size covers any N.
 
 extern "C" __global__ void vector_add(const float* A, const float* B,
-                                       float* C, int N) {
-    int idx = blockIdx.x * blockDim.x + threadIdx.x;
-    if (idx < N) {
+                                       float* C, size_t N) {
+    size_t stride = size_t(gridDim.x) * blockDim.x;
+    for (size_t idx = size_t(blockIdx.x) * blockDim.x + threadIdx.x; idx < N;
+         idx += stride) {
         C[idx] = A[idx] + B[idx];
     }
 }
@@ -10,7 +10,8 @@
 #include <vector>
 
 // CUDA kernel (linked from vector_add.cu)
-extern "C" __global__ void vector_add(const float*, const float*, float*, int);
+extern "C" __global__ void vector_add(const float*, const float*, float*,
+                                       size_t);
 
 static std::vector<char> readFile(const std::string& path) {
     std::ifstream f(path, std::ios::ate | std::ios::binary);
@@ -24,7 +25,7 @@ static std::vector<char> readFile(const std::string& path) {
 
 // ---------- CUDA path ----------
 
-static double runCuda(int N, int iterations) {
+static double runCuda(size_t N, int iterations) {
     std::vector<float> hA(N, 1.0f), hB(N, 2.0f), hC(N, 0.0f);
 
     float *dA, *dB, *dC;
@@ -34,8 +35,9 @@ static double runCuda(int N, int iterations) {
     cudaMemcpy(dA, hA.data(), N * sizeof(float), cudaMemcpyHostToDevice);
     cudaMemcpy(dB, hB.data(), N * sizeof(float), cudaMemcpyHostToDevice);
 
-    int blockSize = 256;
-    int gridSize = (N + blockSize - 1) / blockSize;
+    // One wave of resident blocks; the kernel's grid-stride loop covers N.
+    unsigned blockSize = 256;
+    unsigned gridSize = cuutil::gridStrideBlocks(N, blockSize);
 
     // Warmup
     vector_add<<<gridSize, blockSize>>>(dA, dB, dC, N);
@@ -71,13 +73,13 @@ static double runCuda(int N, int iterations) {
 int main() {
     printf("=== exp02: Vector Add — CUDA vs Vulkan SASS Comparison ===\n\n");
 
-    const int sizes[] = {1 << 20, 16 << 20};  // 1M, 16M
+    const size_t sizes[] = {1 << 20, 16 << 20};  // 1M, 16M
     const int iters = 100;
 
     auto ctx = cuutil::createContext();
 
-    for (int N : sizes) {
-        printf("N = %d (%d M elements)\n", N, N >> 20);
+    for (size_t N : sizes) {
+        printf("N = %zu (%zu M elements)\n", N, N >> 20);
         double cudaMs = runCuda(N, iters);
         printf("  CUDA:   %.3f ms/iter\n", cudaMs);
         // Vulkan path would require full pipeline setup — see post for details
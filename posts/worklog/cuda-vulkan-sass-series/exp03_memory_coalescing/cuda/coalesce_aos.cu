@@ -6,9 +6,10 @@ struct Particle {
 };
 
 extern "C" __global__ void read_aos_x(const Particle* particles, float* out,
-                                       int N) {
-    int idx = blockIdx.x * blockDim.x + threadIdx.x;
-    if (idx < N) {
+                                       size_t N) {
+    size_t stride = size_t(gridDim.x) * blockDim.x;
+    for (size_t idx = size_t(blockIdx.x) * blockDim.x + threadIdx.x; idx < N;
+         idx += stride) {
         out[idx] = particles[idx].x;
     }
 }
@@ -1,9 +1,10 @@
 // coalesce_soa.cu — Read x field from SoA layout.
 // float x[N], y[N], z[N], w[N] — contiguous access, perfect coalescing.
 
-extern "C" __global__ void read_soa_x(const float* x, float* out, int N) {
-    int idx = blockIdx.x * blockDim.x + threadIdx.x;
-    if (idx < N) {
+extern "C" __global__ void read_soa_x(const float* x, float* out, size_t N) {
+    size_t stride = size_t(gridDim.x) * blockDim.x;
+    for (size_t idx = size_t(blockIdx.x) * blockDim.x + threadIdx.x; idx < N;
+         idx += stride) {
         out[idx] = x[idx];
     }
 }
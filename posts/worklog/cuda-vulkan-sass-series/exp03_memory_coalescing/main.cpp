@@ -11,8 +11,8 @@ struct Particle {
 };
 
 // CUDA kernels
-extern "C" __global__ void read_aos_x(const Particle*, float*, int);
-extern "C" __global__ void read_soa_x(const float*, float*, int);
+extern "C" __global__ void read_aos_x(const Particle*, float*, size_t);
+extern "C" __global__ void read_soa_x(const float*, float*, size_t);
 
 int main() {
     printf("=== exp03: Memory Coalescing at SASS Level ===\n\n");
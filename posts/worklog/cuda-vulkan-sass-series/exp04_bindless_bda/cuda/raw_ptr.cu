@@ -2,9 +2,10 @@
 // This is the natural CUDA way: pointer arithmetic, no descriptors.
 
 extern "C" __global__ void read_via_pointer(const float* data, float* out,
-                                             int N) {
-    int idx = blockIdx.x * blockDim.x + threadIdx.x;
-    if (idx < N) {
+                                             size_t N) {
+    size_t stride = size_t(gridDim.x) * blockDim.x;
+    for (size_t idx = size_t(blockIdx.x) * blockDim.x + threadIdx.x; idx < N;
+         idx += stride) {
         out[idx] = data[idx] * 2.0f;
     }
 }
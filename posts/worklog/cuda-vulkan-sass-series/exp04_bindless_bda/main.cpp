@@ -5,7 +5,7 @@
 #include <cstdio>
 #include <vector>
 
-extern "C" __global__ void read_via_pointer(const float*, float*, int);
+extern "C" __global__ void read_via_pointer(const float*, float*, size_t);
 
 int main() {
     printf("=== exp04: Bindless, BDA, Raw Pointers ===\n\n");
@@ -1,9 +1,10 @@
 // jit_kernel.cu — Simple kernel for JIT compilation measurement.
 // When loaded from PTX (not cubin), the CUDA driver JIT-compiles to SASS.
 
-extern "C" __global__ void jit_scale(float* data, float factor, int N) {
-    int idx = blockIdx.x * blockDim.x + threadIdx.x;
-    if (idx < N) {
+extern "C" __global__ void jit_scale(float* data, float factor, size_t N) {
+    size_t stride = size_t(gridDim.x) * blockDim.x;
+    for (size_t idx = size_t(blockIdx.x) * blockDim.x + threadIdx.x; idx < N;
+         idx += stride) {
         data[idx] *= factor;
     }
 }
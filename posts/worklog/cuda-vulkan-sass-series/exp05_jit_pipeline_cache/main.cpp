@@ -1,5 +1,6 @@
 // exp05 — JIT Cache vs Pipeline Cache.
-// Measures cold/warm compilation costs for both CUDA and Vulkan.
+// Measures cold/warm compilation costs for both CUDA and Vulkan. The Vulkan
+// context comes up on a background thread while the CUDA part runs.
 #include "cuda_context.h"
 #include "vk_init.h"
 #include <chrono>
@@ -42,10 +43,14 @@ static void measureCudaJIT() {
 
 // ---------- Vulkan pipeline cache measurement ----------
 
-static void measureVulkanPipelineCache() {
+static void measureVulkanPipelineCache(const vkutil::VkContext& ctx) {
     printf("--- Vulkan Pipeline Cache ---\n");
 
-    auto ctx = vkutil::createComputeContext();
+    const auto& b = ctx.bringUp;
+    printf("  Context bring-up: %.1f ms (instance %.1f, enumerate %.1f, "
+           "select %.1f%s, device %.1f)\n",
+           b.totalMs, b.instanceMs, b.enumerateMs, b.selectMs,
+           b.selectionCached ? " cached" : "", b.deviceMs);
 
     auto spvCode = readFile(std::string(SPV_DIR) + "/cached_kernel.spv");
 
@@ -112,14 +117,14 @@ static void measureVulkanPipelineCache() {
     vkDestroyPipelineCache(ctx.device, cache, nullptr);
     vkDestroyPipelineLayout(ctx.device, layout, nullptr);
     vkDestroyShaderModule(ctx.device, sm, nullptr);
-    ctx.destroy();
 }
 
 int main() {
     printf("=== exp05: JIT Cache vs Pipeline Cache ===\n\n");
 
+    auto vkCtx = vkutil::sharedComputeContextAsync();
     measureCudaJIT();
-    measureVulkanPipelineCache();
+    measureVulkanPipelineCache(*vkCtx.get());
 
     return 0;
 }
@@ -0,0 +1,201 @@
+// exp06 — Runtime shader compilation: GLSL → SPIR-V at runtime with #define
+// variants, an on-disk SPIR-V cache keyed by source+defines hash, and
+// inotify-driven pipeline hot reload.
+//
+// Usage: exp06_runtime_shader [--clear-cache] [--watch]
+#include "shader_compiler.h"
+#include "vk_compute.h"
+#include "vk_init.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct Variant {
+    int localSize;
+    int elemsPerThread;
+};
+
+static vkutil::ShaderDefines definesFor(const Variant& v) {
+    return {{"LOCAL_SIZE", std::to_string(v.localSize)},
+            {"ELEMS_PER_THREAD", std::to_string(v.elemsPerThread)}};
+}
+
+static double msSince(std::chrono::high_resolution_clock::time_point t0) {
+    auto t1 = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(t1 - t0).count();
+}
+
+// Record `iters` dispatches of the kernel, submit, and return ms/iter.
+// One group per chunk where the device allows it; the kernel's grid-stride
+// loop covers the rest.
+static double runKernel(const vkutil::VkContext& ctx, VkCommandBuffer cmd,
+                        const vkutil::ComputeKernel& kernel, const Variant& v,
+                        uint32_t N, int iters) {
+    uint32_t perGroup = v.localSize * v.elemsPerThread;
+    uint32_t groups = vkutil::gridStrideGroups(N, perGroup,
+                                               ctx.maxComputeWorkGroupCountX);
+
+    VkCommandBufferBeginInfo beginInfo{
+        VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    vkBeginCommandBuffer(cmd, &beginInfo);
+    for (int i = 0; i < iters; ++i) {
+        vkutil::recordDispatch(cmd, kernel, &N, groups);
+    }
+    vkEndCommandBuffer(cmd);
+
+    auto t0 = std::chrono::high_resolution_clock::now();
+    vkutil::submitAndWait(ctx, cmd);
+    return msSince(t0) / iters;
+}
+
+static bool verify(const float* C, int N) {
+    for (int i = 0; i < N; i += N / 16) {
+        if (std::fabs(C[i] - 3.0f) > 1e-5f) {
+            fprintf(stderr, "  verify failed at %d: %f\n", i, C[i]);
+            return false;
+        }
+    }
+    return std::fabs(C[N - 1] - 3.0f) <= 1e-5f;
+}
+
+int main(int argc, char** argv) {
+    bool watchMode = false;
+    bool clearCache = false;
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "--watch")) watchMode = true;
+        if (!strcmp(argv[i], "--clear-cache")) clearCache = true;
+    }
+
+    printf("=== exp06: Runtime Shader Compilation + Hot Reload ===\n\n");
+
+    const std::string cacheDir = "spv_cache";
+    const std::string shaderPath =
+        std::string(GLSL_DIR) + "/vector_add_variants.comp";
+    const Variant variants[] = {
+        {64, 1}, {128, 1}, {256, 1}, {256, 2}, {256, 4}, {128, 8},
+    };
+    const int N = 16 << 20;
+    const int iters = 20;
+
+    if (clearCache) {
+        std::filesystem::remove_all(cacheDir);
+        printf("Cleared %s/\n\n", cacheDir.c_str());
+    }
+
+    // --- Compile all variants twice: the second compiler instance stands
+    //     in for a restarted process and should be served from disk. ---
+    std::vector<std::vector<uint32_t>> spirvs;
+    for (int pass = 0; pass < 2; ++pass) {
+        vkutil::ShaderCompiler compiler(cacheDir);
+        printf("--- Compile pass %d (%s) ---\n", pass + 1,
+               pass == 0 ? "fresh process" : "simulated restart");
+        double totalMs = 0.0;
+        for (const auto& v : variants) {
+            auto t0 = std::chrono::high_resolution_clock::now();
+            auto spirv = compiler.compileFile(shaderPath, definesFor(v));
+            double ms = msSince(t0);
+            totalMs += ms;
+            printf("  LOCAL_SIZE=%-4d ELEMS_PER_THREAD=%d  %8.3f ms  %s\n",
+                   v.localSize, v.elemsPerThread, ms,
+                   compiler.lastWasCacheHit() ? "(cache hit)" : "(compiled)");
+            if (pass == 1) spirvs.push_back(std::move(spirv));
+        }
+        printf("  Total: %.3f ms  (%u hits, %u misses)\n\n", totalMs,
+               compiler.cacheHits(), compiler.cacheMisses());
+    }
+
+    // --- Run every variant ---
+    auto ctx = vkutil::createComputeContext();
+    VkDeviceSize bytes = N * sizeof(float);
+    VkDeviceMemory memA, memB, memC;
+    VkBuffer bufA = vkutil::createBuffer(ctx, bytes,
+                                         VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, memA);
+    VkBuffer bufB = vkutil::createBuffer(ctx, bytes,
+                                         VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, memB);
+    VkBuffer bufC = vkutil::createBuffer(ctx, bytes,
+                                         VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, memC);
+
+    float *pA, *pB, *pC;
+    vkMapMemory(ctx.device, memA, 0, bytes, 0, reinterpret_cast<void**>(&pA));
+    vkMapMemory(ctx.device, memB, 0, bytes, 0, reinterpret_cast<void**>(&pB));
+    vkMapMemory(ctx.device, memC, 0, bytes, 0, reinterpret_cast<void**>(&pC));
+    for (int i = 0; i < N; ++i) {
+        pA[i] = 1.0f;
+        pB[i] = 2.0f;
+    }
+
+    VkCommandPool pool = vkutil::createCommandPool(ctx);
+    VkCommandBuffer cmd = vkutil::allocateCommandBuffer(ctx, pool);
+
+    printf("--- Dispatch (N = %d M elements, %d iters) ---\n", N >> 20, iters);
+    for (size_t i = 0; i < spirvs.size(); ++i) {
+        const Variant& v = variants[i];
+        auto t0 = std::chrono::high_resolution_clock::now();
+        auto kernel = vkutil::createComputeKernel(ctx, spirvs[i], 3, sizeof(int));
+        double pipeMs = msSince(t0);
+        vkutil::bindStorageBuffers(ctx, kernel, {bufA, bufB, bufC});
+
+        std::memset(pC, 0, bytes);
+        double ms = runKernel(ctx, cmd, kernel, v, N, iters);
+        printf("  LOCAL_SIZE=%-4d ELEMS_PER_THREAD=%d  pipeline %7.3f ms  "
+               "%.3f ms/iter  %6.1f GB/s  %s\n",
+               v.localSize, v.elemsPerThread, pipeMs, ms,
+               (3.0 * bytes / 1e9) / (ms / 1e3),
+               verify(pC, N) ? "OK" : "FAIL");
+        kernel.destroy(ctx.device);
+    }
+    printf("\n");
+
+    // --- Hot reload loop ---
+    if (watchMode) {
+        const Variant v{256, 1};
+        vkutil::ShaderCompiler compiler(cacheDir);
+        auto kernel = vkutil::createComputeKernel(
+            ctx, compiler.compileFile(shaderPath, definesFor(v)), 3,
+            sizeof(int));
+        vkutil::bindStorageBuffers(ctx, kernel, {bufA, bufB, bufC});
+
+        vkutil::FileWatcher watcher;
+        for (auto& dep : compiler.lastDependencies()) watcher.watch(dep);
+
+        printf("--- Watching %s (Ctrl-C to quit) ---\n", shaderPath.c_str());
+        for (;;) {
+            if (!watcher.poll().empty()) {
+                auto t0 = std::chrono::high_resolution_clock::now();
+                try {
+                    auto spirv = compiler.compileFile(shaderPath, definesFor(v));
+                    vkutil::reloadComputeKernel(ctx, kernel, spirv);
+                    printf("  reloaded in %.3f ms %s\n", msSince(t0),
+                           compiler.lastWasCacheHit() ? "(cache hit)" : "");
+                    watcher.clear();
+                    for (auto& dep : compiler.lastDependencies())
+                        watcher.watch(dep);
+                } catch (const std::runtime_error& e) {
+                    // Keep running the last good pipeline
+                    printf("  %s\n", e.what());
+                }
+            }
+            std::memset(pC, 0, bytes);
+            double ms = runKernel(ctx, cmd, kernel, v, N, 1);
+            printf("  %.3f ms  C[0] = %.2f\n", ms, pC[0]);
+            std::this_thread::sleep_for(std::chrono::milliseconds(500));
+        }
+    }
+
+    vkDestroyCommandPool(ctx.device, pool, nullptr);
+    vkDestroyBuffer(ctx.device, bufA, nullptr);
+    vkDestroyBuffer(ctx.device, bufB, nullptr);
+    vkDestroyBuffer(ctx.device, bufC, nullptr);
+    vkFreeMemory(ctx.device, memA, nullptr);
+    vkFreeMemory(ctx.device, memB, nullptr);
+    vkFreeMemory(ctx.device, memC, nullptr);
+    ctx.destroy();
+    return 0;
+}
@@ -0,0 +1,11 @@
+// scale_inplace.cu — data[i] *= factor, in place.
+// Same body as exp05's jit_scale; here `data` may point at registered host
+// memory, so every load/store crosses the bus.
+
+extern "C" __global__ void scale_inplace(float* data, float factor, size_t N) {
+    size_t stride = size_t(gridDim.x) * blockDim.x;
+    for (size_t idx = size_t(blockIdx.x) * blockDim.x + threadIdx.x; idx < N;
+         idx += stride) {
+        data[idx] *= factor;
+    }
+}
@@ -0,0 +1,276 @@
+// exp07 — Zero-copy host memory.
+// Copy-in / compute / copy-out through device memory (Vulkan stages through
+// a host-visible buffer into a device-local one) vs wrapping the host
+// allocation itself (VK_EXT_external_memory_host, cuMemHostRegister)
+// and processing it in place.
+//
+// Usage: exp07_zero_copy [--file path]   (use an mmap'ed file as host data)
+#include "cuda_context.h"
+#include "host_memory.h"
+#include "vk_compute.h"
+#include "vk_init.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+extern "C" __global__ void scale_inplace(float*, float, size_t);
+
+using Clock = std::chrono::high_resolution_clock;
+
+static double msSince(Clock::time_point t0) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+}
+
+static std::vector<char> readFile(const std::string& path) {
+    std::ifstream f(path, std::ios::ate | std::ios::binary);
+    if (!f.is_open()) { fprintf(stderr, "Cannot open %s\n", path.c_str()); std::abort(); }
+    size_t sz = f.tellg();
+    std::vector<char> buf(sz);
+    f.seekg(0);
+    f.read(buf.data(), sz);
+    return buf;
+}
+
+static hostutil::HostBuffer makeHost(const char* filePath, size_t bytes,
+                                     size_t alignment) {
+    return filePath ? hostutil::mapFile(filePath, bytes)
+                    : hostutil::allocAligned(bytes, alignment);
+}
+
+static void fill(float* data, int N) {
+    for (int i = 0; i < N; ++i) data[i] = float(i & 1023);
+}
+
+static bool verify(const float* data, int N, float factor) {
+    for (int i = 0; i < N; i += 4093) {
+        if (std::fabs(data[i] - float(i & 1023) * factor) > 1e-3f) {
+            fprintf(stderr, "  verify failed at %d: %f\n", i, data[i]);
+            return false;
+        }
+    }
+    return true;
+}
+
+struct Timing {
+    double copyIn = 0, compute = 0, copyOut = 0;  // copy path
+    double import = 0, zcCompute = 0;             // zero-copy path
+};
+
+static void printRow(size_t bytes, const Timing& t) {
+    double copyTotal = t.copyIn + t.compute + t.copyOut;
+    double zcTotal = t.import + t.zcCompute;
+    printf("  %8.2f MB | %8.3f %8.3f %8.3f %8.3f | %8.3f %8.3f %8.3f | %5.2fx\n",
+           bytes / (1024.0 * 1024.0), t.copyIn, t.compute, t.copyOut,
+           copyTotal, t.import, t.zcCompute, zcTotal, copyTotal / zcTotal);
+}
+
+static void printHeader() {
+    printf("  %11s | %8s %8s %8s %8s | %8s %8s %8s |\n", "size", "copy-in",
+           "compute", "copy-out", "total", "import", "compute", "total");
+}
+
+// ---------- Vulkan path ----------
+
+static double dispatchScale(const vkutil::VkContext& ctx, VkCommandBuffer cmd,
+                            const vkutil::ComputeKernel& kernel, float factor,
+                            int N) {
+    struct { float factor; uint32_t N; } pc{factor, uint32_t(N)};
+
+    VkCommandBufferBeginInfo beginInfo{
+        VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    vkBeginCommandBuffer(cmd, &beginInfo);
+    vkutil::recordDispatch(cmd, kernel, &pc, vkutil::gridStrideGroups(N));
+    vkEndCommandBuffer(cmd);
+
+    auto t0 = Clock::now();
+    vkutil::submitAndWait(ctx, cmd);
+    return msSince(t0);
+}
+
+static void runVulkan(const std::vector<size_t>& sizes, int reps,
+                      const char* filePath) {
+    printf("--- Vulkan: staged copy vs VK_EXT_external_memory_host ---\n");
+
+    auto ctx = vkutil::createComputeContext();
+    if (!ctx.hasExternalMemoryHost) {
+        printf("  VK_EXT_external_memory_host not supported — skipping.\n\n");
+        ctx.destroy();
+        return;
+    }
+    printf("  minImportedHostPointerAlignment = %llu bytes\n",
+           static_cast<unsigned long long>(ctx.minImportedHostPointerAlignment));
+
+    auto spv = readFile(std::string(SPV_DIR) + "/scale_inplace.spv");
+    std::vector<uint32_t> spirv(spv.size() / sizeof(uint32_t));
+    std::memcpy(spirv.data(), spv.data(), spv.size());
+    auto kernel = vkutil::createComputeKernel(ctx, spirv, 1, 8);
+
+    VkCommandPool pool = vkutil::createCommandPool(ctx);
+    VkCommandBuffer cmd = vkutil::allocateCommandBuffer(ctx, pool);
+    const float factor = 2.0f;
+
+    printHeader();
+    for (size_t bytes : sizes) {
+        auto host = makeHost(filePath, bytes,
+                             ctx.minImportedHostPointerAlignment);
+        float* hostData = static_cast<float*>(host.data);
+        int N = static_cast<int>(host.bytes / sizeof(float));
+        Timing t;
+        bool ok = true;
+
+        // Copy path: the kernel runs on a device-local buffer; copies go
+        // through a host-visible staging buffer and vkCmdCopyBuffer.
+        const VkBufferUsageFlags transfer =
+            VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+        VkDeviceMemory devMem, stagingMem;
+        VkBuffer devBuf = vkutil::createDeviceLocalBuffer(
+            ctx, host.bytes, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | transfer,
+            devMem);
+        VkBuffer staging =
+            vkutil::createBuffer(ctx, host.bytes, transfer, stagingMem);
+        void* mapped;
+        vkMapMemory(ctx.device, stagingMem, 0, host.bytes, 0, &mapped);
+        vkutil::bindStorageBuffers(ctx, kernel, {devBuf});
+
+        for (int r = 0; r < reps; ++r) {
+            fill(hostData, N);
+            auto t0 = Clock::now();
+            std::memcpy(mapped, hostData, host.bytes);
+            vkutil::copyBuffer(ctx, cmd, staging, devBuf, host.bytes);
+            t.copyIn += msSince(t0);
+            t.compute += dispatchScale(ctx, cmd, kernel, factor, N);
+            t0 = Clock::now();
+            vkutil::copyBuffer(ctx, cmd, devBuf, staging, host.bytes);
+            std::memcpy(hostData, mapped, host.bytes);
+            t.copyOut += msSince(t0);
+            ok = ok && verify(hostData, N, factor);
+        }
+        vkUnmapMemory(ctx.device, stagingMem);
+        vkDestroyBuffer(ctx.device, staging, nullptr);
+        vkFreeMemory(ctx.device, stagingMem, nullptr);
+        vkDestroyBuffer(ctx.device, devBuf, nullptr);
+        vkFreeMemory(ctx.device, devMem, nullptr);
+
+        // Zero-copy path: import the host allocation, process in place
+        for (int r = 0; r < reps; ++r) {
+            fill(hostData, N);
+            auto t0 = Clock::now();
+            VkDeviceMemory importMem;
+            VkBuffer importBuf = vkutil::importHostBuffer(
+                ctx, hostData, host.bytes, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                importMem);
+            vkutil::bindStorageBuffers(ctx, kernel, {importBuf});
+            t.import += msSince(t0);
+            t.zcCompute += dispatchScale(ctx, cmd, kernel, factor, N);
+            ok = ok && verify(hostData, N, factor);
+            vkDestroyBuffer(ctx.device, importBuf, nullptr);
+            vkFreeMemory(ctx.device, importMem, nullptr);
+        }
+
+        t.copyIn /= reps; t.compute /= reps; t.copyOut /= reps;
+        t.import /= reps; t.zcCompute /= reps;
+        printRow(host.bytes, t);
+        if (!ok) printf("  ^ verification FAILED\n");
+        host.release();
+    }
+    printf("\n");
+
+    vkDestroyCommandPool(ctx.device, pool, nullptr);
+    kernel.destroy(ctx.device);
+    ctx.destroy();
+}
+
+// ---------- CUDA path ----------
+
+static double launchScale(CUdeviceptr data, float factor, int N) {
+    int block = 256;
+    int grid = (N + block - 1) / block;
+    auto t0 = Clock::now();
+    scale_inplace<<<grid, block>>>(reinterpret_cast<float*>(data), factor, N);
+    cuCtxSynchronize();
+    return msSince(t0);
+}
+
+static void runCuda(const std::vector<size_t>& sizes, int reps,
+                    const char* filePath) {
+    printf("--- CUDA: cuMemcpyHtoD/DtoH vs cuMemHostRegister ---\n");
+
+    auto ctx = cuutil::createContext();
+    const float factor = 2.0f;
+
+    printHeader();
+    for (size_t bytes : sizes) {
+        auto host = makeHost(filePath, bytes, 0);
+        float* hostData = static_cast<float*>(host.data);
+        int N = static_cast<int>(host.bytes / sizeof(float));
+        Timing t;
+        bool ok = true;
+
+        // Copy path
+        CUdeviceptr dptr = cuutil::allocDevice(host.bytes);
+        launchScale(dptr, 1.0f, N);  // warmup
+        for (int r = 0; r < reps; ++r) {
+            fill(hostData, N);
+            auto t0 = Clock::now();
+            cuutil::copyToDevice(dptr, hostData, host.bytes);
+            t.copyIn += msSince(t0);
+            t.compute += launchScale(dptr, factor, N);
+            t0 = Clock::now();
+            cuutil::copyToHost(hostData, dptr, host.bytes);
+            t.copyOut += msSince(t0);
+            ok = ok && verify(hostData, N, factor);
+        }
+        cuutil::freeDevice(dptr);
+
+        // Zero-copy path: pin + map the host allocation, process in place
+        for (int r = 0; r < reps; ++r) {
+            fill(hostData, N);
+            auto t0 = Clock::now();
+            CUdeviceptr mapped = cuutil::registerHost(hostData, host.bytes);
+            t.import += msSince(t0);
+            t.zcCompute += launchScale(mapped, factor, N);
+            ok = ok && verify(hostData, N, factor);
+            cuutil::unregisterHost(hostData);
+        }
+
+        t.copyIn /= reps; t.compute /= reps; t.copyOut /= reps;
+        t.import /= reps; t.zcCompute /= reps;
+        printRow(host.bytes, t);
+        if (!ok) printf("  ^ verification FAILED\n");
+        host.release();
+    }
+    printf("\n");
+
+    ctx.destroy();
+}
+
+int main(int argc, char** argv) {
+    const char* filePath = nullptr;
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (!strcmp(argv[i], "--file")) filePath = argv[i + 1];
+    }
+
+    printf("=== exp07: Zero-Copy Host Memory Import ===\n");
+    printf("Host data: %s\n\n", filePath ? filePath : "aligned heap allocation");
+
+    std::vector<size_t> sizes;
+    for (size_t bytes = 256 << 10; bytes <= (size_t(256) << 20); bytes *= 4) {
+        sizes.push_back(bytes);
+    }
+    const int reps = 5;
+
+    runVulkan(sizes, reps, filePath);
+    runCuda(sizes, reps, filePath);
+
+    printf("Times in ms, averaged over %d reps. 'import' includes buffer\n"
+           "creation + descriptor update (Vulkan) or pin + map (CUDA); a\n"
+           "streaming pipeline that reuses the same host ring pays it once.\n",
+           reps);
+    return 0;
+}
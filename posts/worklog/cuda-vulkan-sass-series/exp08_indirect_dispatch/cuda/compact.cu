@@ -0,0 +1,48 @@
+// compact.cu — filter → compact → process, CUDA side.
+// Same logic as glsl/filter_compact.comp and glsl/process.comp. The
+// GPU-driven variant sizes the second grid on the device via dynamic
+// parallelism (requires -rdc and cudadevrt).
+
+extern "C" __global__ void filter_compact(const float* values, float* survivors,
+                                          unsigned* count, float threshold,
+                                          int N) {
+    __shared__ unsigned localCount;
+    __shared__ unsigned localBase;
+
+    int idx = blockIdx.x * blockDim.x + threadIdx.x;
+    if (threadIdx.x == 0) localCount = 0;
+    __syncthreads();
+
+    bool keep = idx < N && values[idx] > threshold;
+    unsigned localSlot = keep ? atomicAdd(&localCount, 1u) : 0;
+    __syncthreads();
+
+    if (threadIdx.x == 0) localBase = atomicAdd(count, localCount);
+    __syncthreads();
+
+    if (keep) {
+        survivors[localBase + localSlot] = values[idx];
+    }
+}
+
+extern "C" __global__ void process_survivors(const float* survivors,
+                                             float* results,
+                                             const unsigned* count) {
+    unsigned idx = blockIdx.x * blockDim.x + threadIdx.x;
+    if (idx < *count) {
+        results[idx] = sqrtf(survivors[idx]) * 2.0f + 1.0f;
+    }
+}
+
+// Single-thread launcher: reads the count on the device and launches the
+// next stage with a grid sized to it — the CUDA analogue of
+// vkCmdDispatchIndirect.
+extern "C" __global__ void launch_process(const float* survivors,
+                                          float* results,
+                                          const unsigned* count) {
+    unsigned n = *count;
+    if (n == 0) return;
+    unsigned block = 256;
+    unsigned grid = (n + block - 1) / block;
+    process_survivors<<<grid, block>>>(survivors, results, count);
+}
@@ -0,0 +1,337 @@
+// exp08 — GPU-driven indirect dispatch: filter → compact → process.
+// The second stage's size depends on how many elements survive the filter.
+// Host-roundtrip variant: read the count back, size the next dispatch on the
+// CPU. GPU-driven variant: vkCmdDispatchIndirect (Vulkan) / dynamic
+// parallelism (CUDA), one submission, no readback.
+#include "cuda_context.h"
+#include "vk_compute.h"
+#include "vk_init.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+extern "C" __global__ void filter_compact(const float*, float*, unsigned*,
+                                          float, int);
+extern "C" __global__ void process_survivors(const float*, float*,
+                                             const unsigned*);
+extern "C" __global__ void launch_process(const float*, float*,
+                                          const unsigned*);
+
+using Clock = std::chrono::high_resolution_clock;
+
+static double msSince(Clock::time_point t0) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+}
+
+static std::vector<uint32_t> readSpirv(const std::string& path) {
+    std::ifstream f(path, std::ios::ate | std::ios::binary);
+    if (!f.is_open()) { fprintf(stderr, "Cannot open %s\n", path.c_str()); std::abort(); }
+    size_t sz = f.tellg();
+    std::vector<uint32_t> buf(sz / sizeof(uint32_t));
+    f.seekg(0);
+    f.read(reinterpret_cast<char*>(buf.data()), sz);
+    return buf;
+}
+
+// Deterministic uniform [0, 1) input so selectivity == 1 - threshold.
+static std::vector<float> makeInput(int N) {
+    std::vector<float> v(N);
+    uint32_t s = 12345;
+    for (int i = 0; i < N; ++i) {
+        s = s * 1664525u + 1013904223u;
+        v[i] = (s >> 8) * (1.0f / 16777216.0f);
+    }
+    return v;
+}
+
+struct Expected {
+    uint32_t count = 0;
+    double checksum = 0.0;
+};
+
+static Expected cpuReference(const std::vector<float>& in, float threshold) {
+    Expected e;
+    for (float v : in) {
+        if (v > threshold) {
+            ++e.count;
+            e.checksum += std::sqrt(v) * 2.0 + 1.0;
+        }
+    }
+    return e;
+}
+
+// Survivor order is nondeterministic, so compare count + order-free sum.
+static bool verify(const Expected& e, uint32_t count, const float* results) {
+    if (count != e.count) {
+        fprintf(stderr, "  count mismatch: %u vs %u\n", count, e.count);
+        return false;
+    }
+    double sum = 0.0;
+    for (uint32_t i = 0; i < count; ++i) sum += results[i];
+    return std::fabs(sum - e.checksum) <= 1e-4 * std::fabs(e.checksum) + 1e-3;
+}
+
+// ---------- Vulkan path ----------
+
+struct Control {
+    uint32_t dispatchX, dispatchY, dispatchZ;
+    uint32_t count;
+};
+
+static void recordBegin(VkCommandBuffer cmd) {
+    VkCommandBufferBeginInfo beginInfo{
+        VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    vkBeginCommandBuffer(cmd, &beginInfo);
+}
+
+static void recordBarrier(VkCommandBuffer cmd, VkPipelineStageFlags src,
+                          VkAccessFlags srcAccess, VkPipelineStageFlags dst,
+                          VkAccessFlags dstAccess) {
+    VkMemoryBarrier barrier{VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+    barrier.srcAccessMask = srcAccess;
+    barrier.dstAccessMask = dstAccess;
+    vkCmdPipelineBarrier(cmd, src, dst, 0, 1, &barrier, 0, nullptr, 0,
+                         nullptr);
+}
+
+// Reset the control block and run the filter.
+static void recordFilter(VkCommandBuffer cmd, VkBuffer control,
+                         const vkutil::ComputeKernel& filter, float threshold,
+                         int N) {
+    vkCmdFillBuffer(cmd, control, 0, sizeof(Control), 0);
+    recordBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                  VK_ACCESS_TRANSFER_WRITE_BIT,
+                  VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                  VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
+    struct { float threshold; uint32_t N; } pc{threshold, uint32_t(N)};
+    vkutil::recordDispatch(cmd, filter, &pc, vkutil::gridStrideGroups(N));
+}
+
+static void runVulkan(const std::vector<int>& sizes,
+                      const std::vector<float>& selectivities, int iters) {
+    printf("--- Vulkan: host readback vs vkCmdDispatchIndirect ---\n");
+
+    auto ctx = vkutil::createComputeContext();
+    auto filter = vkutil::createComputeKernel(
+        ctx, readSpirv(std::string(SPV_DIR) + "/filter_compact.spv"), 3, 8);
+    auto build = vkutil::createComputeKernel(
+        ctx, readSpirv(std::string(SPV_DIR) + "/build_indirect.spv"), 1, 0);
+    auto process = vkutil::createComputeKernel(
+        ctx, readSpirv(std::string(SPV_DIR) + "/process.spv"), 3, 0);
+
+    VkCommandPool pool = vkutil::createCommandPool(ctx);
+    VkCommandBuffer cmd = vkutil::allocateCommandBuffer(ctx, pool);
+
+    printf("  %6s %6s | %12s %12s | %7s\n", "N(M)", "keep", "readback ms",
+           "indirect ms", "speedup");
+    for (int N : sizes) {
+        VkDeviceSize bytes = N * sizeof(float);
+        VkDeviceMemory inMem, survMem, outMem, ctlMem;
+        VkBuffer inBuf = vkutil::createBuffer(
+            ctx, bytes, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, inMem);
+        VkBuffer survBuf = vkutil::createBuffer(
+            ctx, bytes, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, survMem);
+        VkBuffer outBuf = vkutil::createBuffer(
+            ctx, bytes, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, outMem);
+        VkBuffer ctlBuf = vkutil::createBuffer(
+            ctx, sizeof(Control),
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT |
+                VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            ctlMem);
+
+        float *pIn, *pOut;
+        Control* pCtl;
+        vkMapMemory(ctx.device, inMem, 0, bytes, 0, reinterpret_cast<void**>(&pIn));
+        vkMapMemory(ctx.device, outMem, 0, bytes, 0, reinterpret_cast<void**>(&pOut));
+        vkMapMemory(ctx.device, ctlMem, 0, sizeof(Control), 0,
+                    reinterpret_cast<void**>(&pCtl));
+        auto input = makeInput(N);
+        std::memcpy(pIn, input.data(), bytes);
+
+        vkutil::bindStorageBuffers(ctx, filter, {inBuf, survBuf, ctlBuf});
+        vkutil::bindStorageBuffers(ctx, build, {ctlBuf});
+        vkutil::bindStorageBuffers(ctx, process, {survBuf, outBuf, ctlBuf});
+
+        for (float keep : selectivities) {
+            float threshold = 1.0f - keep;
+            Expected expected = cpuReference(input, threshold);
+            bool ok = true;
+
+            // Host roundtrip: filter, wait, read count, size dispatch on CPU
+            double readbackMs = 0.0;
+            for (int it = 0; it < iters; ++it) {
+                auto t0 = Clock::now();
+                recordBegin(cmd);
+                recordFilter(cmd, ctlBuf, filter, threshold, N);
+                vkEndCommandBuffer(cmd);
+                vkutil::submitAndWait(ctx, cmd);
+
+                uint32_t count = pCtl->count;
+                recordBegin(cmd);
+                if (count > 0) {
+                    vkutil::recordDispatch(cmd, process, nullptr,
+                                           vkutil::gridStrideGroups(count));
+                }
+                vkEndCommandBuffer(cmd);
+                vkutil::submitAndWait(ctx, cmd);
+                readbackMs += msSince(t0);
+                if (it == 0) ok = ok && verify(expected, count, pOut);
+            }
+
+            // GPU-driven: one submission, indirect dispatch
+            double indirectMs = 0.0;
+            for (int it = 0; it < iters; ++it) {
+                auto t0 = Clock::now();
+                recordBegin(cmd);
+                recordFilter(cmd, ctlBuf, filter, threshold, N);
+                recordBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                              VK_ACCESS_SHADER_WRITE_BIT,
+                              VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                              VK_ACCESS_SHADER_READ_BIT |
+                                  VK_ACCESS_SHADER_WRITE_BIT);
+                vkutil::recordDispatch(cmd, build, nullptr, 1);
+                recordBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                              VK_ACCESS_SHADER_WRITE_BIT,
+                              VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT |
+                                  VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                              VK_ACCESS_INDIRECT_COMMAND_READ_BIT |
+                                  VK_ACCESS_SHADER_READ_BIT);
+                vkutil::recordDispatchIndirect(cmd, process, nullptr, ctlBuf);
+                vkEndCommandBuffer(cmd);
+                vkutil::submitAndWait(ctx, cmd);
+                indirectMs += msSince(t0);
+                if (it == 0) ok = ok && verify(expected, pCtl->count, pOut);
+            }
+
+            readbackMs /= iters;
+            indirectMs /= iters;
+            printf("  %6d %5.0f%% | %12.3f %12.3f | %6.2fx %s\n", N >> 20,
+                   keep * 100.0f, readbackMs, indirectMs,
+                   readbackMs / indirectMs, ok ? "" : "FAIL");
+        }
+
+        vkUnmapMemory(ctx.device, inMem);
+        vkUnmapMemory(ctx.device, outMem);
+        vkUnmapMemory(ctx.device, ctlMem);
+        for (VkBuffer b : {inBuf, survBuf, outBuf, ctlBuf})
+            vkDestroyBuffer(ctx.device, b, nullptr);
+        for (VkDeviceMemory m : {inMem, survMem, outMem, ctlMem})
+            vkFreeMemory(ctx.device, m, nullptr);
+    }
+    printf("\n");
+
+    vkDestroyCommandPool(ctx.device, pool, nullptr);
+    filter.destroy(ctx.device);
+    build.destroy(ctx.device);
+    process.destroy(ctx.device);
+    ctx.destroy();
+}
+
+// ---------- CUDA path ----------
+
+static void runCuda(const std::vector<int>& sizes,
+                    const std::vector<float>& selectivities, int iters) {
+    printf("--- CUDA: host readback vs device-side launch (dynamic parallelism) ---\n");
+
+    auto ctx = cuutil::createContext();
+
+    printf("  %6s %6s | %12s %12s | %7s\n", "N(M)", "keep", "readback ms",
+           "device ms", "speedup");
+    for (int N : sizes) {
+        size_t bytes = N * sizeof(float);
+        auto input = makeInput(N);
+        std::vector<float> hOut(N);
+
+        CUdeviceptr dIn = cuutil::allocDevice(bytes);
+        CUdeviceptr dSurv = cuutil::allocDevice(bytes);
+        CUdeviceptr dOut = cuutil::allocDevice(bytes);
+        CUdeviceptr dCount = cuutil::allocDevice(sizeof(unsigned));
+        cuutil::copyToDevice(dIn, input.data(), bytes);
+
+        auto* in = reinterpret_cast<const float*>(dIn);
+        auto* surv = reinterpret_cast<float*>(dSurv);
+        auto* out = reinterpret_cast<float*>(dOut);
+        auto* count = reinterpret_cast<unsigned*>(dCount);
+        int block = 256;
+        int grid = (N + block - 1) / block;
+
+        for (float keep : selectivities) {
+            float threshold = 1.0f - keep;
+            Expected expected = cpuReference(input, threshold);
+            bool ok = true;
+
+            // Host roundtrip: the count copy is the sync point
+            double readbackMs = 0.0;
+            for (int it = 0; it < iters; ++it) {
+                auto t0 = Clock::now();
+                cuMemsetD32(dCount, 0, 1);
+                filter_compact<<<grid, block>>>(in, surv, count, threshold, N);
+                unsigned hCount = 0;
+                cuutil::copyToHost(&hCount, dCount, sizeof(hCount));
+                if (hCount > 0) {
+                    process_survivors<<<(hCount + block - 1) / block, block>>>(
+                        surv, out, count);
+                }
+                cuCtxSynchronize();
+                readbackMs += msSince(t0);
+                if (it == 0) {
+                    cuutil::copyToHost(hOut.data(), dOut, hCount * sizeof(float));
+                    ok = ok && verify(expected, hCount, hOut.data());
+                }
+            }
+
+            // Device-side sizing: no host sync between the two stages
+            double deviceMs = 0.0;
+            for (int it = 0; it < iters; ++it) {
+                auto t0 = Clock::now();
+                cuMemsetD32(dCount, 0, 1);
+                filter_compact<<<grid, block>>>(in, surv, count, threshold, N);
+                launch_process<<<1, 1>>>(surv, out, count);
+                cuCtxSynchronize();
+                deviceMs += msSince(t0);
+                if (it == 0) {
+                    unsigned hCount = 0;
+                    cuutil::copyToHost(&hCount, dCount, sizeof(hCount));
+                    cuutil::copyToHost(hOut.data(), dOut, hCount * sizeof(float));
+                    ok = ok && verify(expected, hCount, hOut.data());
+                }
+            }
+
+            readbackMs /= iters;
+            deviceMs /= iters;
+            printf("  %6d %5.0f%% | %12.3f %12.3f | %6.2fx %s\n", N >> 20,
+                   keep * 100.0f, readbackMs, deviceMs, readbackMs / deviceMs,
+                   ok ? "" : "FAIL");
+        }
+
+        cuutil::freeDevice(dIn);
+        cuutil::freeDevice(dSurv);
+        cuutil::freeDevice(dOut);
+        cuutil::freeDevice(dCount);
+    }
+    printf("\n");
+
+    ctx.destroy();
+}
+
+int main() {
+    printf("=== exp08: GPU-Driven Indirect Dispatch + Stream Compaction ===\n\n");
+
+    const std::vector<int> sizes = {1 << 20, 16 << 20};
+    const std::vector<float> selectivities = {0.01f, 0.1f, 0.5f, 0.9f};
+    const int iters = 20;
+
+    runVulkan(sizes, selectivities, iters);
+    runCuda(sizes, selectivities, iters);
+
+    printf("Latency is wall time per filter+process round, averaged over %d.\n",
+           iters);
+    return 0;
+}
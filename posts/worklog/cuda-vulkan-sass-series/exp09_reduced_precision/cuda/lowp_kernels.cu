@@ -0,0 +1,122 @@
+// lowp_kernels.cu — vector_add / jit_scale / AoS / SoA readers with
+// fp32, fp16, bf16 and int8 storage. Arithmetic stays fp32; only loads and
+// stores change width. Mirrors glsl/precision.glsl.
+#include <cuda_bf16.h>
+#include <cuda_fp16.h>
+#include <cstdint>
+
+template <typename T>
+struct Codec;
+
+template <>
+struct Codec<float> {
+    __device__ static float load(float v, float) { return v; }
+    __device__ static float store(float v, float) { return v; }
+};
+
+template <>
+struct Codec<__half> {
+    __device__ static float load(__half v, float) { return __half2float(v); }
+    __device__ static __half store(float v, float) { return __float2half_rn(v); }
+};
+
+template <>
+struct Codec<__nv_bfloat16> {
+    __device__ static float load(__nv_bfloat16 v, float) {
+        return __bfloat162float(v);
+    }
+    __device__ static __nv_bfloat16 store(float v, float) {
+        return __float2bfloat16_rn(v);
+    }
+};
+
+// Symmetric linear quantization: value = q * scale, q in [-127, 127].
+template <>
+struct Codec<int8_t> {
+    __device__ static float load(int8_t v, float scale) { return v * scale; }
+    __device__ static int8_t store(float v, float scale) {
+        int q = __float2int_rn(v / scale);
+        return static_cast<int8_t>(max(-127, min(127, q)));
+    }
+};
+
+template <typename T>
+struct Particle4 {
+    T x, y, z, w;
+};
+
+__device__ size_t gridStart() {
+    return size_t(blockIdx.x) * blockDim.x + threadIdx.x;
+}
+
+__device__ size_t gridStride() { return size_t(gridDim.x) * blockDim.x; }
+
+template <typename T>
+__device__ void vectorAdd(const T* A, const T* B, T* C, size_t N, float q) {
+    for (size_t idx = gridStart(); idx < N; idx += gridStride()) {
+        C[idx] = Codec<T>::store(
+            Codec<T>::load(A[idx], q) + Codec<T>::load(B[idx], q), q);
+    }
+}
+
+template <typename T>
+__device__ void scale(T* data, float factor, size_t N, float q) {
+    for (size_t idx = gridStart(); idx < N; idx += gridStride()) {
+        data[idx] = Codec<T>::store(Codec<T>::load(data[idx], q) * factor, q);
+    }
+}
+
+template <typename T>
+__device__ void readAosX(const Particle4<T>* particles, T* out, size_t N,
+                         float q) {
+    for (size_t idx = gridStart(); idx < N; idx += gridStride()) {
+        out[idx] = Codec<T>::store(Codec<T>::load(particles[idx].x, q), q);
+    }
+}
+
+template <typename T>
+__device__ void readSoaX(const T* x, T* out, size_t N, float q) {
+    for (size_t idx = gridStart(); idx < N; idx += gridStride()) {
+        out[idx] = Codec<T>::store(Codec<T>::load(x[idx], q), q);
+    }
+}
+
+// extern "C" entry points (untyped pointers keep the host side free of
+// cuda_fp16.h / cuda_bf16.h). `q` is the int8 scale, ignored otherwise.
+#define DEFINE_LOWP_KERNELS(SUFFIX, T)                                      \
+    extern "C" __global__ void vector_add_##SUFFIX(                         \
+        const void* A, const void* B, void* C, size_t N, float q) {         \
+        vectorAdd(static_cast<const T*>(A), static_cast<const T*>(B),       \
+                  static_cast<T*>(C), N, q);                                \
+    }                                                                       \
+    extern "C" __global__ void jit_scale_##SUFFIX(void* data, float factor, \
+                                                  size_t N, float q) {      \
+        scale(static_cast<T*>(data), factor, N, q);                         \
+    }                                                                       \
+    extern "C" __global__ void read_aos_x_##SUFFIX(const void* particles,   \
+                                                   void* out, size_t N,     \
+                                                   float q) {               \
+        readAosX(static_cast<const Particle4<T>*>(particles),               \
+                 static_cast<T*>(out), N, q);                               \
+    }                                                                       \
+    extern "C" __global__ void read_soa_x_##SUFFIX(const void* x, void* out,\
+                                                   size_t N, float q) {     \
+        readSoaX(static_cast<const T*>(x), static_cast<T*>(out), N, q);     \
+    }
+
+DEFINE_LOWP_KERNELS(fp32, float)
+DEFINE_LOWP_KERNELS(fp16, __half)
+DEFINE_LOWP_KERNELS(bf16, __nv_bfloat16)
+DEFINE_LOWP_KERNELS(int8, int8_t)
+
+// fp16 vector_add with paired __half2 loads/stores: one iteration per two
+// elements, halving the instruction count per byte. N must be even.
+extern "C" __global__ void vector_add_half2(const void* A, const void* B,
+                                            void* C, size_t N, float) {
+    for (size_t idx = gridStart(); idx < N / 2; idx += gridStride()) {
+        float2 a = __half22float2(static_cast<const __half2*>(A)[idx]);
+        float2 b = __half22float2(static_cast<const __half2*>(B)[idx]);
+        static_cast<__half2*>(C)[idx] =
+            __floats2half2_rn(a.x + b.x, a.y + b.y);
+    }
+}
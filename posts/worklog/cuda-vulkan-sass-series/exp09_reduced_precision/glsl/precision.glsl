@@ -0,0 +1,39 @@
+// precision.glsl — Storage-type switch for the reduced-precision kernels.
+// The host defines exactly one of STORAGE_FP32 / STORAGE_FP16 /
+// STORAGE_BF16 / STORAGE_INT8 (plus INT8_SCALE for int8). Arithmetic is
+// always fp32; only the loads and stores change width. The 8/16-bit storage
+// extensions allow those types only in buffer members and conversion
+// constructors, so toF32 / fromF32 are macros that convert in place, never
+// functions taking or returning an 8/16-bit value.
+
+#if defined(STORAGE_FP16)
+#extension GL_EXT_shader_16bit_storage : require
+#define stype float16_t
+#define toF32(v) float(v)
+#define fromF32(v) float16_t(v)
+
+#elif defined(STORAGE_BF16)
+// bf16 is the top half of an fp32; stored as raw uint16_t bits.
+#extension GL_EXT_shader_16bit_storage : require
+#define stype uint16_t
+uint bf16Bits(float v) {
+    uint b = floatBitsToUint(v);
+    b += 0x7FFFu + ((b >> 16) & 1u);  // round to nearest even
+    return b >> 16;
+}
+#define toF32(v) uintBitsToFloat(uint(v) << 16)
+#define fromF32(v) uint16_t(bf16Bits(v))
+
+#elif defined(STORAGE_INT8)
+// Symmetric linear quantization: value = q * INT8_SCALE, q in [-127, 127].
+#extension GL_EXT_shader_8bit_storage : require
+#define stype int8_t
+#define toF32(v) (float(int(v)) * INT8_SCALE)
+#define fromF32(v) \
+    int8_t(int(clamp(round((v) / INT8_SCALE), -127.0, 127.0)))
+
+#else  // STORAGE_FP32
+#define stype float
+#define toF32(v) (v)
+#define fromF32(v) (v)
+#endif
@@ -0,0 +1,452 @@
+// exp09 — Reduced-precision storage for bandwidth-bound kernels.
+// vector_add, jit_scale and the exp03 AoS/SoA readers with fp32, fp16,
+// bf16 and int8 storage, computing in fp32. Reports GB/s, elements/s and
+// max abs error against the fp32 CPU reference.
+#include "cuda_context.h"
+#include "shader_compiler.h"
+#include "vk_compute.h"
+#include "vk_init.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// CUDA kernels (linked from lowp_kernels.cu)
+#define DECLARE_LOWP_KERNELS(SUFFIX)                                          \
+    extern "C" __global__ void vector_add_##SUFFIX(const void*, const void*, \
+                                                   void*, size_t, float);     \
+    extern "C" __global__ void jit_scale_##SUFFIX(void*, float, size_t,      \
+                                                  float);                     \
+    extern "C" __global__ void read_aos_x_##SUFFIX(const void*, void*,       \
+                                                   size_t, float);            \
+    extern "C" __global__ void read_soa_x_##SUFFIX(const void*, void*,       \
+                                                   size_t, float);
+DECLARE_LOWP_KERNELS(fp32)
+DECLARE_LOWP_KERNELS(fp16)
+DECLARE_LOWP_KERNELS(bf16)
+DECLARE_LOWP_KERNELS(int8)
+extern "C" __global__ void vector_add_half2(const void*, const void*, void*,
+                                            size_t, float);
+
+using Clock = std::chrono::high_resolution_clock;
+
+// ---------- Storage formats ----------
+
+enum Storage { FP32, FP16, BF16, INT8, kStorageCount };
+
+struct StorageInfo {
+    const char* name;
+    const char* define;  // for glsl/precision.glsl
+    size_t bytes;
+};
+
+static const StorageInfo kStorage[kStorageCount] = {
+    {"fp32", "STORAGE_FP32", 4},
+    {"fp16", "STORAGE_FP16", 2},
+    {"bf16", "STORAGE_BF16", 2},
+    {"int8", "STORAGE_INT8", 1},
+};
+
+// int8 covers [-127/64, 127/64]; inputs are in [-1, 1) and sums in (-2, 2).
+constexpr float kInt8Scale = 1.0f / 64.0f;
+
+static uint32_t floatBits(float f) {
+    uint32_t u;
+    std::memcpy(&u, &f, sizeof(u));
+    return u;
+}
+
+static float bitsFloat(uint32_t u) {
+    float f;
+    std::memcpy(&f, &u, sizeof(f));
+    return f;
+}
+
+// IEEE binary16, round to nearest even (matches __float2half_rn).
+static uint16_t floatToHalf(float f) {
+    uint32_t x = floatBits(f);
+    uint32_t sign = (x >> 16) & 0x8000u;
+    uint32_t mant = x & 0x7FFFFFu;
+    uint32_t rawExp = (x >> 23) & 0xFFu;
+    int exp = int(rawExp) - 127 + 15;
+
+    if (rawExp == 0xFFu) return sign | 0x7C00u | (mant ? 0x200u : 0u);
+    if (exp >= 31) return sign | 0x7C00u;
+    if (exp <= 0) {  // subnormal half (or zero)
+        if (exp < -10) return sign;
+        mant |= 0x800000u;
+        int shift = 14 - exp;
+        uint32_t h = mant >> shift;
+        uint32_t rem = mant & ((1u << shift) - 1);
+        uint32_t mid = 1u << (shift - 1);
+        if (rem > mid || (rem == mid && (h & 1u))) ++h;
+        return static_cast<uint16_t>(sign | h);
+    }
+    uint32_t h = sign | (uint32_t(exp) << 10) | (mant >> 13);
+    uint32_t rem = mant & 0x1FFFu;
+    if (rem > 0x1000u || (rem == 0x1000u && (h & 1u))) ++h;
+    return static_cast<uint16_t>(h);
+}
+
+static float halfToFloat(uint16_t h) {
+    uint32_t sign = (h & 0x8000u) << 16;
+    uint32_t exp = (h >> 10) & 0x1Fu;
+    uint32_t mant = h & 0x3FFu;
+    if (exp == 0) {
+        float v = std::ldexp(float(mant), -24);
+        return sign ? -v : v;
+    }
+    if (exp == 31) return bitsFloat(sign | 0x7F800000u | (mant << 13));
+    return bitsFloat(sign | ((exp - 15 + 127) << 23) | (mant << 13));
+}
+
+static uint16_t floatToBf16(float f) {
+    uint32_t b = floatBits(f);
+    b += 0x7FFFu + ((b >> 16) & 1u);
+    return static_cast<uint16_t>(b >> 16);
+}
+
+static float bf16ToFloat(uint16_t b) { return bitsFloat(uint32_t(b) << 16); }
+
+static void encode(Storage s, const float* src, void* dst, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        switch (s) {
+        case FP32: static_cast<float*>(dst)[i] = src[i]; break;
+        case FP16: static_cast<uint16_t*>(dst)[i] = floatToHalf(src[i]); break;
+        case BF16: static_cast<uint16_t*>(dst)[i] = floatToBf16(src[i]); break;
+        case INT8: {
+            long q = std::lrint(src[i] / kInt8Scale);
+            static_cast<int8_t*>(dst)[i] =
+                static_cast<int8_t>(std::max(-127L, std::min(127L, q)));
+            break;
+        }
+        default: break;
+        }
+    }
+}
+
+static void decode(Storage s, const void* src, float* dst, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        switch (s) {
+        case FP32: dst[i] = static_cast<const float*>(src)[i]; break;
+        case FP16: dst[i] = halfToFloat(static_cast<const uint16_t*>(src)[i]); break;
+        case BF16: dst[i] = bf16ToFloat(static_cast<const uint16_t*>(src)[i]); break;
+        case INT8: dst[i] = static_cast<const int8_t*>(src)[i] * kInt8Scale; break;
+        default: break;
+        }
+    }
+}
+
+// ---------- Workloads ----------
+
+enum KernelId { VECTOR_ADD, SCALE, READ_AOS, READ_SOA, kKernelCount };
+
+struct Workload {
+    const char* name;
+    const char* glsl;
+    std::vector<std::vector<float>> inputs;  // one per input binding
+    std::vector<float> reference;            // fp32 CPU result
+    bool inPlace;                            // result overwrites inputs[0]
+    int usefulPerElem;  // elements read+written per output (AoS: x only)
+};
+
+constexpr float kScaleFactor = 0.5f;
+
+static std::vector<Workload> makeWorkloads(int N) {
+    std::vector<float> a(N), b(N), particles(4 * size_t(N));
+    uint32_t s = 2024;
+    auto rnd = [&s] {
+        s = s * 1664525u + 1013904223u;
+        return (s >> 8) * (2.0f / 16777216.0f) - 1.0f;  // [-1, 1)
+    };
+    for (int i = 0; i < N; ++i) {
+        a[i] = rnd();
+        b[i] = rnd();
+        particles[4 * size_t(i) + 0] = a[i];
+        particles[4 * size_t(i) + 1] = rnd();
+        particles[4 * size_t(i) + 2] = rnd();
+        particles[4 * size_t(i) + 3] = rnd();
+    }
+
+    std::vector<float> sum(N), scaled(N);
+    for (int i = 0; i < N; ++i) {
+        sum[i] = a[i] + b[i];
+        scaled[i] = a[i] * kScaleFactor;
+    }
+
+    return {
+        {"vector_add", "vector_add_lp.comp", {a, b}, sum, false, 3},
+        {"jit_scale", "scale_lp.comp", {a}, scaled, true, 2},
+        {"read_aos_x", "read_aos_lp.comp", {particles}, a, false, 2},
+        {"read_soa_x", "read_soa_lp.comp", {a}, a, false, 2},
+    };
+}
+
+static double maxError(Storage s, const void* result,
+                       const std::vector<float>& reference) {
+    std::vector<float> decoded(reference.size());
+    decode(s, result, decoded.data(), decoded.size());
+    double err = 0.0;
+    for (size_t i = 0; i < reference.size(); ++i) {
+        err = std::max(err, double(std::fabs(decoded[i] - reference[i])));
+    }
+    return err;
+}
+
+static void printHeader() {
+    printf("  %-11s %-6s | %9s %9s %10s | %10s\n", "kernel", "type",
+           "ms/iter", "GB/s", "Gelem/s", "max err");
+}
+
+static void printRow(const Workload& w, const char* type, size_t elemBytes,
+                     int N, double ms, double err) {
+    double bytes = double(w.usefulPerElem) * N * elemBytes;
+    printf("  %-11s %-6s | %9.3f %9.1f %10.2f | %10.3e\n", w.name, type, ms,
+           (bytes / 1e9) / (ms / 1e3), (N / 1e9) / (ms / 1e3), err);
+}
+
+// ---------- Vulkan path ----------
+
+static void runVulkan(const std::vector<Workload>& workloads, int N,
+                      int iters) {
+    printf("--- Vulkan ---\n");
+    auto ctx = vkutil::createComputeContext();
+    printf("  storageBuffer16BitAccess=%d storageBuffer8BitAccess=%d "
+           "shaderFloat16=%d shaderInt8=%d\n",
+           ctx.hasStorage16, ctx.hasStorage8, ctx.hasFloat16, ctx.hasInt8);
+
+    vkutil::ShaderCompiler compiler("spv_cache");
+    VkCommandPool pool = vkutil::createCommandPool(ctx);
+    VkCommandBuffer cmd = vkutil::allocateCommandBuffer(ctx, pool);
+    printHeader();
+
+    for (const auto& w : workloads) {
+        for (int s = 0; s < kStorageCount; ++s) {
+            Storage st = static_cast<Storage>(s);
+            if ((st == FP16 || st == BF16) && !ctx.hasStorage16) continue;
+            if (st == INT8 && !ctx.hasStorage8) continue;
+            size_t elemBytes = kStorage[s].bytes;
+
+            char scaleStr[32];
+            snprintf(scaleStr, sizeof(scaleStr), "%.9g", kInt8Scale);
+            auto spirv = compiler.compileFile(
+                std::string(GLSL_DIR) + "/" + w.glsl,
+                {{kStorage[s].define, "1"}, {"INT8_SCALE", scaleStr}});
+
+            // Device-local inputs, then a separate output unless the kernel
+            // is in place; encoded data goes in and results come back out
+            // through one host-visible staging buffer sized for the largest.
+            const VkBufferUsageFlags usage =
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                VK_BUFFER_USAGE_TRANSFER_SRC_BIT |
+                VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+            VkDeviceSize stagingBytes = N * elemBytes;
+            for (const auto& in : w.inputs) {
+                stagingBytes = std::max<VkDeviceSize>(stagingBytes,
+                                                      in.size() * elemBytes);
+            }
+            VkDeviceMemory stagingMem;
+            VkBuffer staging = vkutil::createBuffer(
+                ctx, stagingBytes,
+                VK_BUFFER_USAGE_TRANSFER_SRC_BIT |
+                    VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                stagingMem);
+            void* mapped;
+            vkMapMemory(ctx.device, stagingMem, 0, stagingBytes, 0, &mapped);
+
+            std::vector<VkBuffer> buffers;
+            std::vector<VkDeviceMemory> memories;
+            for (const auto& in : w.inputs) {
+                VkDeviceSize bytes = in.size() * elemBytes;
+                VkDeviceMemory mem;
+                buffers.push_back(
+                    vkutil::createDeviceLocalBuffer(ctx, bytes, usage, mem));
+                memories.push_back(mem);
+                encode(st, in.data(), mapped, in.size());
+                vkutil::copyBuffer(ctx, cmd, staging, buffers.back(), bytes);
+            }
+            if (!w.inPlace) {
+                VkDeviceMemory mem;
+                buffers.push_back(vkutil::createDeviceLocalBuffer(
+                    ctx, N * elemBytes, usage, mem));
+                memories.push_back(mem);
+            }
+
+            uint32_t count = static_cast<uint32_t>(N);
+            struct { float factor; uint32_t N; } scalePc{kScaleFactor, count};
+            bool isScale = w.inPlace;
+            auto kernel = vkutil::createComputeKernel(
+                ctx, spirv, static_cast<uint32_t>(buffers.size()),
+                isScale ? sizeof(scalePc) : sizeof(count));
+            vkutil::bindStorageBuffers(ctx, kernel, buffers);
+            const void* pc = isScale ? static_cast<const void*>(&scalePc)
+                                     : static_cast<const void*>(&count);
+            uint32_t groups = vkutil::gridStrideGroups(count);
+
+            VkCommandBufferBeginInfo beginInfo{
+                VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
+            beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+            // Correctness pass (the scale runs exactly once here)
+            vkBeginCommandBuffer(cmd, &beginInfo);
+            vkutil::recordDispatch(cmd, kernel, pc, groups);
+            vkEndCommandBuffer(cmd);
+            vkutil::submitAndWait(ctx, cmd);
+
+            vkutil::copyBuffer(ctx, cmd, buffers.back(), staging,
+                               N * elemBytes);
+            double err = maxError(st, mapped, w.reference);
+
+            // Timed pass; factor 1 keeps repeated in-place scaling stable
+            scalePc.factor = 1.0f;
+            vkBeginCommandBuffer(cmd, &beginInfo);
+            for (int i = 0; i < iters; ++i) {
+                if (i > 0) vkutil::recordComputeBarrier(cmd);
+                vkutil::recordDispatch(cmd, kernel, pc, groups);
+            }
+            vkEndCommandBuffer(cmd);
+            auto t0 = Clock::now();
+            vkutil::submitAndWait(ctx, cmd);
+            double ms = std::chrono::duration<double, std::milli>(
+                            Clock::now() - t0).count() / iters;
+
+            printRow(w, kStorage[s].name, elemBytes, N, ms, err);
+
+            kernel.destroy(ctx.device);
+            for (VkBuffer b : buffers) vkDestroyBuffer(ctx.device, b, nullptr);
+            for (VkDeviceMemory m : memories) vkFreeMemory(ctx.device, m, nullptr);
+            vkUnmapMemory(ctx.device, stagingMem);
+            vkDestroyBuffer(ctx.device, staging, nullptr);
+            vkFreeMemory(ctx.device, stagingMem, nullptr);
+        }
+    }
+    printf("\n");
+
+    vkDestroyCommandPool(ctx.device, pool, nullptr);
+    ctx.destroy();
+}
+
+// ---------- CUDA path ----------
+
+using VecAddFn = void (*)(const void*, const void*, void*, size_t, float);
+using ScaleFn = void (*)(void*, float, size_t, float);
+using ReadFn = void (*)(const void*, void*, size_t, float);
+
+static const VecAddFn kCudaVecAdd[kStorageCount] = {
+    vector_add_fp32, vector_add_fp16, vector_add_bf16, vector_add_int8};
+static const ScaleFn kCudaScale[kStorageCount] = {
+    jit_scale_fp32, jit_scale_fp16, jit_scale_bf16, jit_scale_int8};
+static const ReadFn kCudaReadAos[kStorageCount] = {
+    read_aos_x_fp32, read_aos_x_fp16, read_aos_x_bf16, read_aos_x_int8};
+static const ReadFn kCudaReadSoa[kStorageCount] = {
+    read_soa_x_fp32, read_soa_x_fp16, read_soa_x_bf16, read_soa_x_int8};
+
+// Every lowp kernel is grid-stride over size_t N; `grid` comes from
+// cuutil::gridStrideBlocks (over N / 2 pairs for half2).
+static void launchCuda(KernelId k, int s, bool half2,
+                       const std::vector<CUdeviceptr>& ptrs, float factor,
+                       size_t N, unsigned grid) {
+    const int block = 256;
+    auto p = [&ptrs](size_t i) { return reinterpret_cast<void*>(ptrs[i]); };
+
+    switch (k) {
+    case VECTOR_ADD:
+        if (half2) {
+            vector_add_half2<<<grid, block>>>(p(0), p(1), p(2), N,
+                                              kInt8Scale);
+        } else {
+            kCudaVecAdd[s]<<<grid, block>>>(p(0), p(1), p(2), N, kInt8Scale);
+        }
+        break;
+    case SCALE:
+        kCudaScale[s]<<<grid, block>>>(p(0), factor, N, kInt8Scale);
+        break;
+    case READ_AOS:
+        kCudaReadAos[s]<<<grid, block>>>(p(0), p(1), N, kInt8Scale);
+        break;
+    case READ_SOA:
+        kCudaReadSoa[s]<<<grid, block>>>(p(0), p(1), N, kInt8Scale);
+        break;
+    default:
+        break;
+    }
+}
+
+static void runCuda(const std::vector<Workload>& workloads, int N,
+                    int iters) {
+    printf("--- CUDA ---\n");
+    auto ctx = cuutil::createContext();
+    printHeader();
+
+    for (int k = 0; k < kKernelCount; ++k) {
+        const Workload& w = workloads[k];
+        // Extra fp16 row for vector_add: paired __half2 loads/stores
+        int variants = (k == VECTOR_ADD) ? kStorageCount + 1 : kStorageCount;
+        for (int v = 0; v < variants; ++v) {
+            bool half2 = v == kStorageCount;
+            int s = half2 ? FP16 : v;
+            Storage st = static_cast<Storage>(s);
+            size_t elemBytes = kStorage[s].bytes;
+
+            std::vector<CUdeviceptr> ptrs;
+            std::vector<char> staging;
+            for (const auto& in : w.inputs) {
+                size_t bytes = in.size() * elemBytes;
+                staging.resize(bytes);
+                encode(st, in.data(), staging.data(), in.size());
+                ptrs.push_back(cuutil::allocDevice(bytes));
+                cuutil::copyToDevice(ptrs.back(), staging.data(), bytes);
+            }
+            if (!w.inPlace) ptrs.push_back(cuutil::allocDevice(N * elemBytes));
+
+            // Sized once, outside the timed loop: it queries the device
+            unsigned grid =
+                cuutil::gridStrideBlocks(half2 ? size_t(N) / 2 : size_t(N));
+
+            // Correctness pass
+            launchCuda(static_cast<KernelId>(k), s, half2, ptrs, kScaleFactor,
+                       N, grid);
+            cuCtxSynchronize();
+            staging.resize(N * elemBytes);
+            cuutil::copyToHost(staging.data(), ptrs.back(), N * elemBytes);
+            double err = maxError(st, staging.data(), w.reference);
+
+            // Timed pass; factor 1 keeps repeated in-place scaling stable
+            auto t0 = Clock::now();
+            for (int i = 0; i < iters; ++i) {
+                launchCuda(static_cast<KernelId>(k), s, half2, ptrs, 1.0f, N,
+                           grid);
+            }
+            cuCtxSynchronize();
+            double ms = std::chrono::duration<double, std::milli>(
+                            Clock::now() - t0).count() / iters;
+
+            printRow(w, half2 ? "fp16x2" : kStorage[s].name, elemBytes, N,
+                     ms, err);
+            for (CUdeviceptr p : ptrs) cuutil::freeDevice(p);
+        }
+    }
+    printf("\n");
+
+    ctx.destroy();
+}
+
+int main() {
+    printf("=== exp09: Reduced-Precision Storage (FP16/BF16/INT8) ===\n\n");
+
+    const int N = 4 << 20;  // 4M elements (exp03's particle count)
+    const int iters = 50;
+    auto workloads = makeWorkloads(N);
+
+    runVulkan(workloads, N, iters);
+    runCuda(workloads, N, iters);
+
+    printf("GB/s counts useful bytes only (AoS: the x field, as in exp03).\n"
+           "Max error is against the fp32 CPU reference; int8 uses scale %g.\n",
+           kInt8Scale);
+    return 0;
+}
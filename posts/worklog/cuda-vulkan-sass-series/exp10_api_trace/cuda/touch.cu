@@ -0,0 +1,9 @@
+// touch.cu — data[i] += 1. Same as glsl/touch.comp.
+
+extern "C" __global__ void touch(float* data, size_t N) {
+    size_t stride = size_t(gridDim.x) * blockDim.x;
+    for (size_t idx = size_t(blockIdx.x) * blockDim.x + threadIdx.x; idx < N;
+         idx += stride) {
+        data[idx] += 1.0f;
+    }
+}
@@ -0,0 +1,152 @@
+// exp10 — API call tracing: how much host time goes into the driver.
+// Every vk*/cu* call inside the shared helpers goes through API_TRACE (and
+// VK_CHECK/CU_CHECK, which wrap it); calls an experiment makes directly
+// (vkMapMemory, vkCmd*, cuCtxSynchronize, ...) are traced only where it
+// wraps them itself, as this file does. This experiment measures the
+// tracer's own overhead, then traces a typical bring-up + dispatch loop.
+//
+// Two ways to trace another experiment:
+//   SASS_API_TRACE=1 SASS_API_TRACE_FILE=trace.json ./exp13_grid_stride
+//     shared-helper calls only;
+//   LD_PRELOAD=./libapi_trace_preload.so ./exp13_grid_stride
+//     every exported vk*/cu* call, no code changes. Neither sees the CUDA
+//     runtime (cudaMalloc, <<<>>>), which reaches the driver through
+//     cuGetProcAddress.
+#include "api_trace.h"
+#include "cuda_context.h"
+#include "vk_compute.h"
+#include "vk_init.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+
+extern "C" __global__ void touch(float*, size_t);
+
+using Clock = std::chrono::high_resolution_clock;
+
+static std::vector<uint32_t> readSpirv(const std::string& path) {
+    std::ifstream f(path, std::ios::ate | std::ios::binary);
+    if (!f.is_open()) { fprintf(stderr, "Cannot open %s\n", path.c_str()); std::abort(); }
+    size_t sz = f.tellg();
+    std::vector<uint32_t> buf(sz / sizeof(uint32_t));
+    f.seekg(0);
+    f.read(reinterpret_cast<char*>(buf.data()), sz);
+    return buf;
+}
+
+template <typename F>
+static double nsPerCall(int calls, F&& f) {
+    auto t0 = Clock::now();
+    for (int i = 0; i < calls; ++i) f();
+    return std::chrono::duration<double, std::nano>(Clock::now() - t0).count() /
+           calls;
+}
+
+// ---------- Tracer overhead ----------
+
+static void measureOverhead(const vkutil::VkContext& ctx) {
+    printf("--- Tracer overhead (vkGetDeviceQueue, ns/call) ---\n");
+    const int calls = 200000;
+    VkQueue q;
+
+    bool wasEnabled = apitrace::enabled();
+    apitrace::setEnabled(false);
+    double direct = nsPerCall(calls, [&] {
+        vkGetDeviceQueue(ctx.device, ctx.computeQueueFamily, 0, &q);
+    });
+    double disabled = nsPerCall(calls, [&] {
+        API_TRACE(vkGetDeviceQueue(ctx.device, ctx.computeQueueFamily, 0, &q));
+    });
+    apitrace::setEnabled(true);
+    double enabled = nsPerCall(calls, [&] {
+        API_TRACE(vkGetDeviceQueue(ctx.device, ctx.computeQueueFamily, 0, &q));
+    });
+    apitrace::setEnabled(wasEnabled);
+    apitrace::reset();
+
+    printf("  direct:            %7.1f ns\n", direct);
+    printf("  traced, disabled:  %7.1f ns  (+%.1f)\n", disabled,
+           disabled - direct);
+    printf("  traced, enabled:   %7.1f ns  (+%.1f)\n\n", enabled,
+           enabled - direct);
+}
+
+// ---------- Traced workloads ----------
+
+static void vulkanWorkload(uint32_t N, int iters) {
+    auto ctx = vkutil::createComputeContext();
+
+    VkDeviceMemory mem;
+    VkBuffer buf = vkutil::createBuffer(ctx, N * sizeof(float),
+                                        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, mem);
+    auto kernel = vkutil::createComputeKernel(
+        ctx, readSpirv(std::string(SPV_DIR) + "/touch.spv"), 1, sizeof(N));
+    vkutil::bindStorageBuffers(ctx, kernel, {buf});
+
+    VkCommandPool pool = vkutil::createCommandPool(ctx);
+    VkCommandBuffer cmd = vkutil::allocateCommandBuffer(ctx, pool);
+    VkCommandBufferBeginInfo beginInfo{
+        VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    for (int i = 0; i < iters; ++i) {
+        API_TRACE(vkBeginCommandBuffer(cmd, &beginInfo));
+        vkutil::recordDispatch(cmd, kernel, &N, vkutil::gridStrideGroups(N));
+        API_TRACE(vkEndCommandBuffer(cmd));
+        vkutil::submitAndWait(ctx, cmd);
+    }
+
+    API_TRACE(vkDestroyCommandPool(ctx.device, pool, nullptr));
+    kernel.destroy(ctx.device);
+    API_TRACE(vkDestroyBuffer(ctx.device, buf, nullptr));
+    API_TRACE(vkFreeMemory(ctx.device, mem, nullptr));
+    ctx.destroy();
+}
+
+static void cudaWorkload(int N, int iters) {
+    auto ctx = cuutil::createContext();
+
+    std::vector<float> host(N, 0.0f);
+    CUdeviceptr d = cuutil::allocDevice(N * sizeof(float));
+    for (int i = 0; i < iters; ++i) {
+        cuutil::copyToDevice(d, host.data(), N * sizeof(float));
+        touch<<<(N + 255) / 256, 256>>>(reinterpret_cast<float*>(d), N);
+        API_TRACE(cuCtxSynchronize());
+        cuutil::copyToHost(host.data(), d, N * sizeof(float));
+    }
+    cuutil::freeDevice(d);
+    ctx.destroy();
+}
+
+int main() {
+    printf("=== exp10: Vulkan / CUDA API Call Tracing ===\n\n");
+
+    const int N = 1 << 20;
+    const int iters = 100;
+
+    {
+        auto ctx = vkutil::createComputeContext();
+        measureOverhead(ctx);
+        ctx.destroy();
+    }
+
+    apitrace::reset();
+    apitrace::setEnabled(true);
+    auto t0 = Clock::now();
+    vulkanWorkload(N, iters);
+    cudaWorkload(N, iters);
+    double wallMs =
+        std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+    apitrace::setEnabled(false);
+
+    printf("Traced workload wall time: %.3f ms\n", wallMs);
+    apitrace::dumpSummary(stdout);
+    if (apitrace::writeChromeTrace("exp10_api_trace.json")) {
+        printf("\nChrome trace written to exp10_api_trace.json "
+               "(open in ui.perfetto.dev)\n");
+    }
+    return 0;
+}
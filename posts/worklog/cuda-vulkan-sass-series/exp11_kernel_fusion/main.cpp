@@ -0,0 +1,381 @@
+// exp11 — Kernel fusion with expression templates.
+// An element-wise chain of K ops (alternating "+ array" and "* scalar", the
+// vector_add / jit_scale pattern) run two ways on CPU, Vulkan and CUDA:
+//   unfused: one kernel per op, every intermediate round-trips memory
+//   fused:   fuse::lower() turns the whole chain into one generated kernel
+// Both sides use kernels generated by fuse.h, so the only difference is the
+// memory traffic between ops.
+#include "cuda_context.h"
+#include "fuse.h"
+#include "shader_compiler.h"
+#include "vk_compute.h"
+#include "vk_init.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <utility>
+#include <vector>
+
+using Clock = std::chrono::high_resolution_clock;
+
+// Array slots shared by every chain: inputs A..D, two ping-pong temporaries
+// for the unfused path. The fused result goes to a separate output array.
+enum Slot { A, B, C, D, T0, T1, kSlotCount };
+
+constexpr float kScale = 0.75f;
+constexpr int kMinOps = 2;
+constexpr int kMaxOps = 8;
+
+// ---------- Chains ----------
+
+// Op j (1-based) adds B, C, D, B, ... when odd and scales when even:
+// ((((A + B) * s) + C) * s) + ...
+static fuse::Buffer addend(int j) {
+    static const fuse::Buffer kAddends[] = {{B}, {C}, {D}};
+    return kAddends[(j / 2) % 3];
+}
+
+template <int K>
+static auto chain() {
+    if constexpr (K == 0) {
+        return fuse::Buffer{A};
+    } else if constexpr (K % 2 == 1) {
+        return chain<K - 1>() + addend(K);
+    } else {
+        return chain<K - 1>() * kScale;
+    }
+}
+
+using CpuFn =
+    std::function<void(float*, const std::vector<const float*>&, size_t)>;
+
+struct Step {
+    fuse::Fused f;
+    int dst;
+    CpuFn cpu;
+};
+
+struct Chain {
+    int ops;
+    fuse::Fused fused;
+    std::vector<Step> unfused;  // result ends in unfused.back().dst
+    CpuFn cpuFused;
+
+    size_t fusedBytes() const { return fused.bytesPerElement(); }
+    size_t unfusedBytes() const {
+        size_t b = 0;
+        for (const auto& s : unfused) b += s.f.bytesPerElement();
+        return b;
+    }
+};
+
+template <typename E>
+static CpuFn cpuFn(const E& e) {
+    return [e](float* out, const std::vector<const float*>& in, size_t n) {
+        fuse::evalCpu(e, out, in, n);
+    };
+}
+
+template <typename E>
+static Step makeStep(const E& e, int dst) {
+    return {fuse::lower(e), dst, cpuFn(e)};
+}
+
+template <int K>
+static Chain makeChain() {
+    Chain c;
+    c.ops = K;
+    c.fused = fuse::lower(chain<K>());
+    c.cpuFused = cpuFn(chain<K>());
+
+    // The same ops one kernel at a time, ping-ponging between T0 and T1.
+    int src = A;
+    for (int j = 1; j <= K; ++j) {
+        int dst = (j % 2) ? T1 : T0;
+        fuse::Buffer x{src};
+        c.unfused.push_back((j % 2) ? makeStep(x + addend(j), dst)
+                                    : makeStep(x * kScale, dst));
+        src = dst;
+    }
+    return c;
+}
+
+template <int... K>
+static std::vector<Chain> makeChains(std::integer_sequence<int, K...>) {
+    return {makeChain<K + kMinOps>()...};
+}
+
+static double maxError(const float* result, const std::vector<float>& ref) {
+    double err = 0.0;
+    for (size_t i = 0; i < ref.size(); ++i) {
+        err = std::max(err, double(std::fabs(result[i] - ref[i])));
+    }
+    return err;
+}
+
+static void printHeader() {
+    printf("  %3s | %9s %9s %8s | %10s %10s | %9s\n", "ops", "fused ms",
+           "unfused", "speedup", "fused GB/s", "unf. GB/s", "max err");
+}
+
+static void printRow(const Chain& c, int N, double fusedMs, double unfusedMs,
+                     double err) {
+    double fusedGB = double(c.fusedBytes()) * N / 1e9;
+    double unfusedGB = double(c.unfusedBytes()) * N / 1e9;
+    printf("  %3d | %9.3f %9.3f %7.2fx | %10.1f %10.1f | %9.2e\n", c.ops,
+           fusedMs, unfusedMs, unfusedMs / fusedMs, fusedGB / (fusedMs / 1e3),
+           unfusedGB / (unfusedMs / 1e3), err);
+}
+
+// ---------- CPU ----------
+
+static void runCpu(const std::vector<Chain>& chains,
+                   std::vector<std::vector<float>>& arrays,
+                   const std::vector<std::vector<float>>& refs, int N,
+                   int iters) {
+    printf("--- CPU (vectorized evalCpu loop, 1 thread) ---\n");
+    printHeader();
+
+    std::vector<float> out(N);
+    std::vector<const float*> in;
+    for (const auto& a : arrays) in.push_back(a.data());
+
+    for (size_t ci = 0; ci < chains.size(); ++ci) {
+        const Chain& c = chains[ci];
+
+        auto t0 = Clock::now();
+        for (int i = 0; i < iters; ++i) c.cpuFused(out.data(), in, N);
+        double fusedMs = std::chrono::duration<double, std::milli>(
+                             Clock::now() - t0).count() / iters;
+        double err = maxError(out.data(), refs[ci]);
+
+        // Unfused: each op is its own pass over memory.
+        t0 = Clock::now();
+        for (int i = 0; i < iters; ++i) {
+            for (const auto& s : c.unfused) s.cpu(arrays[s.dst].data(), in, N);
+        }
+        double unfusedMs = std::chrono::duration<double, std::milli>(
+                               Clock::now() - t0).count() / iters;
+        err = std::max(err,
+                       maxError(arrays[c.unfused.back().dst].data(), refs[ci]));
+
+        printRow(c, N, fusedMs, unfusedMs, err);
+    }
+    printf("\n");
+}
+
+// ---------- Vulkan ----------
+
+static void runVulkan(const std::vector<Chain>& chains,
+                      const std::vector<std::vector<float>>& arrays,
+                      const std::vector<std::vector<float>>& refs, int N,
+                      int iters) {
+    printf("--- Vulkan (GLSL generated, compiled at runtime) ---\n");
+    auto ctx = vkutil::createComputeContext();
+    vkutil::ShaderCompiler compiler("spv_cache");
+    fuse::VkFuser fuser(ctx, compiler);
+
+    VkCommandPool pool = vkutil::createCommandPool(ctx);
+    VkCommandBuffer cmd = vkutil::allocateCommandBuffer(ctx, pool);
+
+    // Device-local arrays, like cuMemAlloc on the CUDA side; inputs go in
+    // and results come back through one host-visible staging buffer.
+    VkDeviceSize bytes = VkDeviceSize(N) * sizeof(float);
+    VkDeviceMemory stagingMem;
+    VkBuffer staging = vkutil::createBuffer(
+        ctx, bytes,
+        VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        stagingMem);
+    void* mapped;
+    vkMapMemory(ctx.device, stagingMem, 0, bytes, 0, &mapped);
+
+    std::vector<VkBuffer> bufs(kSlotCount + 1);
+    std::vector<VkDeviceMemory> mems(kSlotCount + 1);
+    for (int s = 0; s <= kSlotCount; ++s) {
+        bufs[s] = vkutil::createDeviceLocalBuffer(
+            ctx, bytes,
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                VK_BUFFER_USAGE_TRANSFER_SRC_BIT |
+                VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            mems[s]);
+        if (s < T0) {
+            memcpy(mapped, arrays[s].data(), bytes);
+            vkutil::copyBuffer(ctx, cmd, staging, bufs[s], bytes);
+        }
+    }
+    VkBuffer outBuf = bufs[kSlotCount];
+    std::vector<VkBuffer> slots(bufs.begin(), bufs.begin() + kSlotCount);
+
+    VkCommandBufferBeginInfo beginInfo{
+        VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    auto timeSubmit = [&](auto&& recordOnce) {
+        vkBeginCommandBuffer(cmd, &beginInfo);
+        for (int i = 0; i < iters; ++i) {
+            if (i > 0) vkutil::recordComputeBarrier(cmd);
+            recordOnce();
+        }
+        vkEndCommandBuffer(cmd);
+        auto t0 = Clock::now();
+        vkutil::submitAndWait(ctx, cmd);
+        return std::chrono::duration<double, std::milli>(Clock::now() - t0)
+                   .count() / iters;
+    };
+    auto readError = [&](int bufIndex, const std::vector<float>& ref) {
+        vkutil::copyBuffer(ctx, cmd, bufs[bufIndex], staging, bytes);
+        return maxError(static_cast<const float*>(mapped), ref);
+    };
+
+    printHeader();
+    for (size_t ci = 0; ci < chains.size(); ++ci) {
+        const Chain& c = chains[ci];
+
+        VkDescriptorSet fusedSet = fuser.bind(c.fused, outBuf, slots);
+        std::vector<VkDescriptorSet> stepSets;
+        for (const auto& s : c.unfused) {
+            stepSets.push_back(fuser.bind(s.f, bufs[s.dst], slots));
+        }
+
+        double fusedMs = timeSubmit(
+            [&] { fuser.record(cmd, c.fused, fusedSet, N); });
+        double unfusedMs = timeSubmit([&] {
+            for (size_t j = 0; j < c.unfused.size(); ++j) {
+                if (j > 0) vkutil::recordComputeBarrier(cmd);
+                fuser.record(cmd, c.unfused[j].f, stepSets[j], N);
+            }
+        });
+
+        double err = std::max(readError(kSlotCount, refs[ci]),
+                              readError(c.unfused.back().dst, refs[ci]));
+        printRow(c, N, fusedMs, unfusedMs, err);
+        fuser.resetBindings();
+    }
+    printf("  %zu kernels generated, %.1f ms compiling (cache: %u hits, "
+           "%u misses)\n\n",
+           fuser.kernelCount(), fuser.compileMs(), compiler.cacheHits(),
+           compiler.cacheMisses());
+
+    vkDestroyCommandPool(ctx.device, pool, nullptr);
+    for (int s = 0; s <= kSlotCount; ++s) {
+        vkDestroyBuffer(ctx.device, bufs[s], nullptr);
+        vkFreeMemory(ctx.device, mems[s], nullptr);
+    }
+    vkUnmapMemory(ctx.device, stagingMem);
+    vkDestroyBuffer(ctx.device, staging, nullptr);
+    vkFreeMemory(ctx.device, stagingMem, nullptr);
+    ctx.destroy();
+}
+
+// ---------- CUDA ----------
+
+static void runCuda(const std::vector<Chain>& chains,
+                    const std::vector<std::vector<float>>& arrays,
+                    const std::vector<std::vector<float>>& refs, int N,
+                    int iters) {
+    printf("--- CUDA (C++ generated, compiled with NVRTC) ---\n");
+    auto ctx = cuutil::createContext();
+    size_t bytes = size_t(N) * sizeof(float);
+
+    {
+        fuse::CuFuser fuser;
+        std::vector<CUdeviceptr> slots(kSlotCount);
+        for (int s = 0; s < kSlotCount; ++s) {
+            slots[s] = cuutil::allocDevice(bytes);
+            if (s < T0) cuutil::copyToDevice(slots[s], arrays[s].data(), bytes);
+        }
+        CUdeviceptr out = cuutil::allocDevice(bytes);
+        std::vector<float> host(N);
+
+        auto timeLaunches = [&](auto&& launchOnce) {
+            launchOnce();  // compile + warm up outside the timed loop
+            cuCtxSynchronize();
+            auto t0 = Clock::now();
+            for (int i = 0; i < iters; ++i) launchOnce();
+            cuCtxSynchronize();
+            return std::chrono::duration<double, std::milli>(
+                       Clock::now() - t0).count() / iters;
+        };
+        auto readError = [&](CUdeviceptr p, const std::vector<float>& ref) {
+            cuutil::copyToHost(host.data(), p, bytes);
+            return maxError(host.data(), ref);
+        };
+
+        printHeader();
+        for (size_t ci = 0; ci < chains.size(); ++ci) {
+            const Chain& c = chains[ci];
+            double fusedMs = timeLaunches(
+                [&] { fuser.launch(c.fused, out, slots, N); });
+            double unfusedMs = timeLaunches([&] {
+                for (const auto& s : c.unfused) {
+                    fuser.launch(s.f, slots[s.dst], slots, N);
+                }
+            });
+            double err = std::max(readError(out, refs[ci]),
+                                  readError(slots[c.unfused.back().dst],
+                                            refs[ci]));
+            printRow(c, N, fusedMs, unfusedMs, err);
+        }
+        printf("  %zu kernels generated, %.1f ms compiling\n\n",
+               fuser.kernelCount(), fuser.compileMs());
+
+        for (CUdeviceptr p : slots) cuutil::freeDevice(p);
+        cuutil::freeDevice(out);
+    }
+
+    ctx.destroy();
+}
+
+int main(int argc, char** argv) {
+    printf("=== exp11: Expression-Template Kernel Fusion ===\n\n");
+
+    int N = 16 << 20;  // 64 MB per array: well past L2 on every target
+    const int iters = 20;
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "--n") && i + 1 < argc) N = atoi(argv[++i]);
+    }
+
+    auto chains = makeChains(
+        std::make_integer_sequence<int, kMaxOps - kMinOps + 1>{});
+    printf("Chains (N = %d):\n", N);
+    for (const auto& c : chains) {
+        printf("  %d ops: %s\n", c.ops, c.fused.expr.c_str());
+    }
+    printf("\n");
+
+    // Inputs in [-1, 1); temporaries start zeroed.
+    std::vector<std::vector<float>> arrays(kSlotCount, std::vector<float>(N));
+    uint32_t seed = 11;
+    for (int s = 0; s < T0; ++s) {
+        for (auto& v : arrays[s]) {
+            seed = seed * 1664525u + 1013904223u;
+            v = (seed >> 8) * (2.0f / 16777216.0f) - 1.0f;
+        }
+    }
+
+    // Plain scalar reference, independent of fuse.h.
+    std::vector<std::vector<float>> refs;
+    for (const auto& c : chains) {
+        std::vector<float> r(arrays[A]);
+        for (int j = 1; j <= c.ops; ++j) {
+            const auto& add = arrays[addend(j).slot];
+            for (int i = 0; i < N; ++i) {
+                r[i] = (j % 2) ? r[i] + add[i] : r[i] * kScale;
+            }
+        }
+        refs.push_back(std::move(r));
+    }
+
+    runCpu(chains, arrays, refs, N, iters);
+    runVulkan(chains, arrays, refs, N, iters);
+    runCuda(chains, arrays, refs, N, iters);
+
+    printf("GB/s counts the bytes each variant must move: fused reads every\n"
+           "distinct input once and writes once; unfused also writes and\n"
+           "re-reads every intermediate.\n");
+    return 0;
+}
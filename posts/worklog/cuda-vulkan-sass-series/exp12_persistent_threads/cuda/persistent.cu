@@ -0,0 +1,166 @@
+// persistent.cu — Per-task kernel and persistent-blocks worker, CUDA side.
+// Same queue protocol and task splitting as glsl/queue.glsl and
+// glsl/persistent.comp; see those files for the invariants.
+
+struct QueueHeader {
+    unsigned head;
+    unsigned tail;
+    unsigned pending;
+    unsigned dequeued;
+    unsigned pushed;
+    unsigned inlined;
+    unsigned pad0;
+    unsigned pad1;
+};
+
+struct QueueSlot {
+    unsigned seq;
+    unsigned offset;
+    unsigned count;
+    unsigned pad;
+};
+
+struct Task {
+    unsigned offset;
+    unsigned count;
+};
+
+__device__ unsigned work(unsigned idx, unsigned rounds) {
+    unsigned x = idx ^ 0x9E3779B9u;
+    for (unsigned r = 0; r < rounds; ++r) {
+        x ^= x >> 16;
+        x *= 0x7FEB352Du;
+        x ^= x >> 15;
+        x *= 0x846CA68Bu;
+        x ^= x >> 16;
+    }
+    return x;
+}
+
+__device__ unsigned atomicLoad(unsigned* p) { return atomicAdd(p, 0u); }
+
+__device__ bool queuePush(QueueHeader* q, QueueSlot* slots, Task t,
+                          unsigned mask) {
+    unsigned pos = atomicLoad(&q->tail);
+    for (;;) {
+        QueueSlot& s = slots[pos & mask];
+        int diff = int(atomicLoad(&s.seq) - pos);
+        if (diff == 0) {
+            unsigned prev = atomicCAS(&q->tail, pos, pos + 1u);
+            if (prev == pos) {
+                s.offset = t.offset;
+                s.count = t.count;
+                __threadfence();
+                atomicExch(&s.seq, pos + 1u);  // publish
+                return true;
+            }
+            pos = prev;
+        } else if (diff < 0) {
+            return false;  // full
+        } else {
+            pos = atomicLoad(&q->tail);  // lost a race; reload
+        }
+    }
+}
+
+__device__ bool queuePop(QueueHeader* q, QueueSlot* slots, Task& t,
+                         unsigned mask) {
+    unsigned pos = atomicLoad(&q->head);
+    for (;;) {
+        QueueSlot& s = slots[pos & mask];
+        int diff = int(atomicLoad(&s.seq) - (pos + 1u));
+        if (diff == 0) {
+            unsigned prev = atomicCAS(&q->head, pos, pos + 1u);
+            if (prev == pos) {
+                __threadfence();
+                const volatile QueueSlot& vs = s;
+                t.offset = vs.offset;
+                t.count = vs.count;
+                __threadfence();
+                atomicExch(&s.seq, pos + mask + 1u);  // free
+                return true;
+            }
+            pos = prev;
+        } else if (diff < 0) {
+            return false;  // empty, or the producer has not published yet
+        } else {
+            pos = atomicLoad(&q->head);
+        }
+    }
+}
+
+extern "C" __global__ void task_kernel(unsigned offset, unsigned count,
+                                       unsigned* results, unsigned* visits,
+                                       unsigned rounds) {
+    unsigned k = blockIdx.x * blockDim.x + threadIdx.x;
+    if (k < count) {
+        unsigned idx = offset + k;
+        results[idx] = work(idx, rounds);
+        atomicAdd(&visits[idx], 1u);
+    }
+}
+
+enum { STATE_TASK, STATE_IDLE, STATE_EXIT };
+
+extern "C" __global__ void persistent_worker(void* queue, unsigned* results,
+                                             unsigned* visits, unsigned mask,
+                                             unsigned splitThreshold,
+                                             unsigned rounds) {
+    QueueHeader* q = static_cast<QueueHeader*>(queue);
+    QueueSlot* slots = reinterpret_cast<QueueSlot*>(q + 1);
+    __shared__ Task sTask;
+    __shared__ unsigned sState;
+    bool leader = threadIdx.x == 0;
+
+    for (;;) {
+        if (leader) {
+            Task t{0u, 0u};
+            unsigned state;
+            if (queuePop(q, slots, t, mask)) {
+                atomicAdd(&q->dequeued, 1u);
+                state = STATE_TASK;
+            } else {
+                state = atomicLoad(&q->pending) == 0u ? STATE_EXIT : STATE_IDLE;
+            }
+
+            while (state == STATE_TASK && splitThreshold != 0u &&
+                   t.count > splitThreshold) {
+                unsigned keep = t.count / 2u;
+                Task upper{t.offset + keep, t.count - keep};
+                atomicAdd(&q->pending, 1u);
+                if (!queuePush(q, slots, upper, mask)) {
+                    atomicSub(&q->pending, 1u);
+                    atomicAdd(&q->inlined, 1u);
+                    break;
+                }
+                atomicAdd(&q->pushed, 1u);
+                t.count = keep;
+            }
+            sTask = t;
+            sState = state;
+        }
+        __syncthreads();
+
+        unsigned state = sState;
+        if (state == STATE_EXIT) break;
+
+        Task t = sTask;
+        for (unsigned k = threadIdx.x; k < t.count; k += blockDim.x) {
+            unsigned idx = t.offset + k;
+            results[idx] = work(idx, rounds);
+            atomicAdd(&visits[idx], 1u);
+        }
+        __syncthreads();
+
+        if (leader && state == STATE_TASK) atomicSub(&q->pending, 1u);
+    }
+}
+
+// Resident blocks per SM for persistent_worker, so the host can size the
+// grid to exactly fill the device.
+extern "C" int persistent_blocks_per_sm(int blockSize) {
+    int blocks = 0;
+    cudaOccupancyMaxActiveBlocksPerMultiprocessor(&blocks, persistent_worker,
+                                                  blockSize, 0);
+    return blocks;
+}
@@ -0,0 +1,81 @@
+// queue.glsl — Bounded lock-free MPMC queue in a storage buffer.
+// Every slot carries a sequence number (Vyukov's bounded queue): seq == pos
+// means the slot is free for the producer that claims position `pos`,
+// seq == pos + 1 means it holds that producer's task for the consumer that
+// claims `pos`. Positions are claimed with atomicCompSwap on head/tail.
+// Neither side ever waits for another invocation to finish a step — a
+// full or not-yet-published slot just fails the call — so the queue needs
+// no forward-progress guarantee between invocations.
+// Layout mirrors QueueHeader/QueueSlot in main.cpp.
+
+struct Task {
+    uint offset;
+    uint count;
+};
+
+struct QueueSlot {
+    uint seq;
+    uint offset;
+    uint count;
+    uint pad;
+};
+
+layout(std430, binding = 0) coherent buffer Queue {
+    uint head;
+    uint tail;
+    uint pending;   // tasks queued or being processed; 0 => all done
+    uint dequeued;  // statistics
+    uint pushed;    // tasks appended by the GPU
+    uint inlined;   // splits skipped because the queue was full
+    uint pad0;
+    uint pad1;
+    QueueSlot slots[];
+};
+
+bool queuePush(Task t, uint mask) {
+    uint pos = atomicAdd(tail, 0u);
+    for (;;) {
+        uint i = pos & mask;
+        int diff = int(atomicAdd(slots[i].seq, 0u) - pos);
+        if (diff == 0) {
+            uint prev = atomicCompSwap(tail, pos, pos + 1u);
+            if (prev == pos) {
+                slots[i].offset = t.offset;
+                slots[i].count = t.count;
+                memoryBarrierBuffer();
+                atomicExchange(slots[i].seq, pos + 1u);  // publish
+                return true;
+            }
+            pos = prev;
+        } else if (diff < 0) {
+            return false;  // full
+        } else {
+            pos = atomicAdd(tail, 0u);  // lost a race; reload
+        }
+    }
+    return false;
+}
+
+bool queuePop(out Task t, uint mask) {
+    uint pos = atomicAdd(head, 0u);
+    for (;;) {
+        uint i = pos & mask;
+        int diff = int(atomicAdd(slots[i].seq, 0u) - (pos + 1u));
+        if (diff == 0) {
+            uint prev = atomicCompSwap(head, pos, pos + 1u);
+            if (prev == pos) {
+                memoryBarrierBuffer();
+                t = Task(slots[i].offset, slots[i].count);
+                memoryBarrierBuffer();
+                atomicExchange(slots[i].seq, pos + mask + 1u);  // free
+                return true;
+            }
+            pos = prev;
+        } else if (diff < 0) {
+            return false;  // empty, or the producer has not published yet
+        } else {
+            pos = atomicAdd(head, 0u);
+        }
+    }
+    return false;
+}
@@ -0,0 +1,15 @@
+// work.glsl — Per-element work shared by task.comp and persistent.comp:
+// `rounds` rounds of an integer hash, so the host can check every result
+// exactly. Same function as work() in cuda/persistent.cu.
+
+uint work(uint idx, uint rounds) {
+    uint x = idx ^ 0x9E3779B9u;
+    for (uint r = 0; r < rounds; ++r) {
+        x ^= x >> 16;
+        x *= 0x7FEB352Du;
+        x ^= x >> 15;
+        x *= 0x846CA68Bu;
+        x ^= x >> 16;
+    }
+    return x;
+}
@@ -0,0 +1,520 @@
+// exp12 — Persistent threads with a lock-free GPU work queue.
+// Many small, uneven tasks (heavy-tailed lengths) run two ways:
+//   per-task:   one vkCmdDispatch / kernel launch per task
+//   persistent: a fixed grid sized to the device drains an MPMC queue held
+//               in a storage buffer (glsl/queue.glsl, cuda/persistent.cu);
+//               large tasks are split on the GPU and halves pushed back
+// Every element must be visited exactly once; results are checked exactly.
+//
+//   --stress [rounds]  randomized Vulkan-only queue stress test (lavapipe)
+//   --groups N         override the Vulkan persistent grid size
+#include "cuda_context.h"
+#include "shader_compiler.h"
+#include "vk_compute.h"
+#include "vk_init.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+extern "C" __global__ void task_kernel(unsigned, unsigned, unsigned*,
+                                       unsigned*, unsigned);
+extern "C" __global__ void persistent_worker(void*, unsigned*, unsigned*,
+                                             unsigned, unsigned, unsigned);
+extern "C" int persistent_blocks_per_sm(int blockSize);
+
+using Clock = std::chrono::high_resolution_clock;
+
+static double msSince(Clock::time_point t0) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+}
+
+// ---------- Queue layout ----------
+// Must match glsl/queue.glsl and cuda/persistent.cu.
+
+struct QueueHeader {
+    uint32_t head;
+    uint32_t tail;
+    uint32_t pending;
+    uint32_t dequeued;
+    uint32_t pushed;
+    uint32_t inlined;
+    uint32_t pad0;
+    uint32_t pad1;
+};
+
+struct QueueSlot {
+    uint32_t seq;
+    uint32_t offset;
+    uint32_t count;
+    uint32_t pad;
+};
+
+static_assert(sizeof(QueueHeader) == 32, "queue header layout");
+static_assert(sizeof(QueueSlot) == 16, "queue slot layout");
+
+struct Task {
+    uint32_t offset;
+    uint32_t count;
+};
+
+constexpr uint32_t kBlock = 64;  // workgroup / block size of both kernels
+
+static uint32_t nextPow2(uint32_t v) {
+    uint32_t p = 1;
+    while (p < v) p <<= 1;
+    return p;
+}
+
+// Host side of the queue: all `tasks` already pushed, nothing popped.
+static std::vector<uint8_t> buildQueue(const std::vector<Task>& tasks,
+                                       uint32_t capacity) {
+    std::vector<uint8_t> bytes(sizeof(QueueHeader) +
+                               size_t(capacity) * sizeof(QueueSlot));
+    auto* h = reinterpret_cast<QueueHeader*>(bytes.data());
+    auto* slots = reinterpret_cast<QueueSlot*>(h + 1);
+    *h = {};
+    h->tail = static_cast<uint32_t>(tasks.size());
+    h->pending = static_cast<uint32_t>(tasks.size());
+    for (uint32_t pos = 0; pos < capacity; ++pos) {
+        if (pos < tasks.size()) {
+            slots[pos] = {pos + 1, tasks[pos].offset, tasks[pos].count, 0};
+        } else {
+            slots[pos] = {pos, 0, 0, 0};
+        }
+    }
+    return bytes;
+}
+
+// ---------- Workload ----------
+
+struct Rng {
+    uint32_t s;
+    uint32_t next() {
+        s = s * 1664525u + 1013904223u;
+        return s >> 8;
+    }
+    float uniform() { return next() * (1.0f / 16777216.0f); }
+};
+
+// Heavy-tailed lengths in [1, maxLen]: most tasks are tiny, a few are big.
+static std::vector<Task> makeTasks(uint32_t count, uint32_t maxLen,
+                                   Rng& rng, uint32_t& total) {
+    std::vector<Task> tasks(count);
+    total = 0;
+    for (auto& t : tasks) {
+        float u = rng.uniform();
+        t.offset = total;
+        t.count = 1 + static_cast<uint32_t>(u * u * u * u * (maxLen - 1));
+        total += t.count;
+    }
+    return tasks;
+}
+
+static uint32_t work(uint32_t idx, uint32_t rounds) {
+    uint32_t x = idx ^ 0x9E3779B9u;
+    for (uint32_t r = 0; r < rounds; ++r) {
+        x ^= x >> 16;
+        x *= 0x7FEB352Du;
+        x ^= x >> 15;
+        x *= 0x846CA68Bu;
+        x ^= x >> 16;
+    }
+    return x;
+}
+
+// Exactly-once + exact results; for persistent runs also the queue's own
+// bookkeeping (drained, nothing lost: every push was popped once).
+static bool verify(const uint32_t* results, const uint32_t* visits,
+                   uint32_t total, uint32_t rounds, const QueueHeader* q,
+                   uint32_t taskCount) {
+    uint32_t badVisits = 0, badResults = 0;
+    for (uint32_t i = 0; i < total; ++i) {
+        if (visits[i] != 1) ++badVisits;
+        if (results[i] != work(i, rounds)) ++badResults;
+    }
+    bool ok = badVisits == 0 && badResults == 0;
+    if (q) {
+        ok = ok && q->pending == 0 && q->head == q->tail &&
+             q->dequeued == taskCount + q->pushed;
+    }
+    if (!ok) {
+        printf("    FAILED: %u elements not visited exactly once, %u wrong "
+               "results", badVisits, badResults);
+        if (q) {
+            printf(", head=%u tail=%u pending=%u dequeued=%u pushed=%u",
+                   q->head, q->tail, q->pending, q->dequeued, q->pushed);
+        }
+        printf("\n");
+    }
+    return ok;
+}
+
+struct RunResult {
+    double ms = 0.0;
+    bool ok = false;
+    QueueHeader stats{};
+};
+
+static void printHeader() {
+    printf("  %-22s | %9s %9s | %8s %8s %8s | %s\n", "mode", "ms",
+           "Gelem/s", "popped", "pushed", "inlined", "check");
+}
+
+static void printRow(const char* mode, const RunResult& r, uint32_t total,
+                     bool persistent) {
+    printf("  %-22s | %9.3f %9.3f | ", mode, r.ms,
+           (total / 1e9) / (r.ms / 1e3));
+    if (persistent) {
+        printf("%8u %8u %8u", r.stats.dequeued, r.stats.pushed,
+               r.stats.inlined);
+    } else {
+        printf("%8s %8s %8s", "-", "-", "-");
+    }
+    printf(" | %s\n", r.ok ? "ok" : "FAILED");
+}
+
+// ---------- Vulkan ----------
+
+struct VkBench {
+    vkutil::VkContext ctx;
+    vkutil::ComputeKernel persistent;
+    vkutil::ComputeKernel perTask;
+    VkCommandPool pool = VK_NULL_HANDLE;
+    VkCommandBuffer cmd = VK_NULL_HANDLE;
+
+    // Device-local, like cuMemAlloc on the CUDA side: the queue's atomics
+    // must not cross the bus. `staging` (host-visible, mapped) carries the
+    // queue in and the header, results and visits out.
+    VkBuffer queue = VK_NULL_HANDLE, results = VK_NULL_HANDLE,
+             visits = VK_NULL_HANDLE, staging = VK_NULL_HANDLE;
+    VkDeviceMemory queueMem = VK_NULL_HANDLE, resultsMem = VK_NULL_HANDLE,
+                   visitsMem = VK_NULL_HANDLE, stagingMem = VK_NULL_HANDLE;
+    uint8_t* stagingPtr = nullptr;
+    uint32_t capacity = 0, elements = 0;
+
+    VkBench() : ctx(vkutil::createComputeContext()) {
+        vkutil::ShaderCompiler compiler("spv_cache");
+        std::string dir = GLSL_DIR;
+        persistent = vkutil::createComputeKernel(
+            ctx, compiler.compileFile(dir + "/persistent.comp"), 3,
+            3 * sizeof(uint32_t));
+        perTask = vkutil::createComputeKernel(
+            ctx, compiler.compileFile(dir + "/task.comp"), 2,
+            3 * sizeof(uint32_t));
+        pool = vkutil::createCommandPool(ctx);
+        cmd = vkutil::allocateCommandBuffer(ctx, pool);
+    }
+
+    ~VkBench() {
+        freeBuffers();
+        vkDestroyCommandPool(ctx.device, pool, nullptr);
+        persistent.destroy(ctx.device);
+        perTask.destroy(ctx.device);
+        ctx.destroy();
+    }
+
+    void freeBuffers() {
+        if (stagingPtr) vkUnmapMemory(ctx.device, stagingMem);
+        for (auto [b, m] : {std::make_pair(queue, queueMem),
+                            std::make_pair(results, resultsMem),
+                            std::make_pair(visits, visitsMem),
+                            std::make_pair(staging, stagingMem)}) {
+            if (b) vkDestroyBuffer(ctx.device, b, nullptr);
+            if (m) vkFreeMemory(ctx.device, m, nullptr);
+        }
+        queue = results = visits = staging = VK_NULL_HANDLE;
+        queueMem = resultsMem = visitsMem = stagingMem = VK_NULL_HANDLE;
+        stagingPtr = nullptr;
+        capacity = elements = 0;
+    }
+
+    // (Re)allocate only when the problem outgrows the current buffers.
+    void reserve(uint32_t cap, uint32_t total) {
+        if (cap <= capacity && total <= elements) return;
+        vkDeviceWaitIdle(ctx.device);
+        freeBuffers();
+        capacity = cap;
+        elements = total;
+        auto usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                     VK_BUFFER_USAGE_TRANSFER_SRC_BIT |
+                     VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+        VkDeviceSize queueBytes =
+            sizeof(QueueHeader) + VkDeviceSize(cap) * sizeof(QueueSlot);
+        VkDeviceSize arrayBytes = VkDeviceSize(total) * 4;
+        queue = vkutil::createDeviceLocalBuffer(ctx, queueBytes, usage,
+                                                queueMem);
+        results = vkutil::createDeviceLocalBuffer(ctx, arrayBytes, usage,
+                                                  resultsMem);
+        visits = vkutil::createDeviceLocalBuffer(ctx, arrayBytes, usage,
+                                                 visitsMem);
+        // Results and visits are read back side by side for verify()
+        VkDeviceSize stagingBytes = std::max(queueBytes, 2 * arrayBytes);
+        staging = vkutil::createBuffer(
+            ctx, stagingBytes,
+            VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            stagingMem);
+        void* p;
+        vkMapMemory(ctx.device, stagingMem, 0, stagingBytes, 0, &p);
+        stagingPtr = static_cast<uint8_t*>(p);
+        vkutil::bindStorageBuffers(ctx, persistent, {queue, results, visits});
+        vkutil::bindStorageBuffers(ctx, perTask, {results, visits});
+    }
+
+    void upload(VkBuffer dst, const void* src, size_t bytes) {
+        memcpy(stagingPtr, src, bytes);
+        vkutil::copyBuffer(ctx, cmd, staging, dst, bytes);
+    }
+
+    void clearVisits(uint32_t total) {
+        submit([&] {
+            vkCmdFillBuffer(cmd, visits, 0, VkDeviceSize(total) * 4, 0);
+            VkMemoryBarrier barrier{VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+            barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            barrier.dstAccessMask =
+                VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+            vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                 VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1,
+                                 &barrier, 0, nullptr, 0, nullptr);
+        });
+    }
+
+    double submit(const std::function<void()>& record) {
+        VkCommandBufferBeginInfo beginInfo{
+            VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        vkBeginCommandBuffer(cmd, &beginInfo);
+        record();
+        vkEndCommandBuffer(cmd);
+        auto t0 = Clock::now();
+        vkutil::submitAndWait(ctx, cmd);
+        return msSince(t0);
+    }
+
+    bool check(uint32_t total, uint32_t rounds, const QueueHeader* q,
+               uint32_t taskCount) {
+        VkDeviceSize bytes = VkDeviceSize(total) * 4;
+        vkutil::copyBuffer(ctx, cmd, results, staging, {{0, 0, bytes}});
+        vkutil::copyBuffer(ctx, cmd, visits, staging, {{0, bytes, bytes}});
+        auto* r = reinterpret_cast<const uint32_t*>(stagingPtr);
+        return verify(r, r + total, total, rounds, q, taskCount);
+    }
+
+    RunResult runPerTask(const std::vector<Task>& tasks, uint32_t total,
+                         uint32_t rounds) {
+        reserve(1, total);
+        clearVisits(total);
+        RunResult r;
+        r.ms = submit([&] {
+            for (const Task& t : tasks) {
+                uint32_t pc[3] = {t.offset, t.count, rounds};
+                vkutil::recordDispatch(cmd, perTask, pc,
+                                       (t.count + kBlock - 1) / kBlock);
+            }
+        });
+        r.ok = check(total, rounds, nullptr, 0);
+        return r;
+    }
+
+    RunResult runPersistent(const std::vector<Task>& tasks, uint32_t total,
+                            uint32_t cap, uint32_t split, uint32_t groups,
+                            uint32_t rounds) {
+        reserve(cap, total);
+        auto q = buildQueue(tasks, cap);
+        upload(queue, q.data(), q.size());
+        clearVisits(total);
+
+        RunResult r;
+        uint32_t pc[3] = {cap - 1, split, rounds};
+        r.ms = submit(
+            [&] { vkutil::recordDispatch(cmd, persistent, pc, groups); });
+
+        vkutil::copyBuffer(ctx, cmd, queue, staging, sizeof(QueueHeader));
+        memcpy(&r.stats, stagingPtr, sizeof(QueueHeader));
+        r.ok = check(total, rounds, &r.stats,
+                     static_cast<uint32_t>(tasks.size()));
+        return r;
+    }
+};
+
+static uint32_t defaultVulkanGroups(const vkutil::VkContext& ctx) {
+    // Vulkan has no occupancy query. On a CPU implementation (lavapipe) one
+    // workgroup per hardware thread; on a GPU enough 64-wide groups to fill
+    // a large part (~2K resident threads per SM x ~64 SMs). Extra groups only
+    // find the queue drained and exit.
+    VkPhysicalDeviceProperties props;
+    vkGetPhysicalDeviceProperties(ctx.physicalDevice, &props);
+    if (props.deviceType == VK_PHYSICAL_DEVICE_TYPE_CPU) {
+        return std::max(1u, std::thread::hardware_concurrency());
+    }
+    return 2048;
+}
+
+static void runVulkan(const std::vector<Task>& tasks, uint32_t total,
+                      uint32_t rounds, uint32_t groups) {
+    printf("--- Vulkan ---\n");
+    VkBench b;
+    if (groups == 0) groups = defaultVulkanGroups(b.ctx);
+    uint32_t cap = nextPow2(static_cast<uint32_t>(tasks.size()) * 2);
+    printf("  persistent grid: %u workgroups x %u, queue capacity %u\n",
+           groups, kBlock, cap);
+    printHeader();
+
+    printRow("per-task dispatch", b.runPerTask(tasks, total, rounds), total,
+             false);
+    printRow("persistent",
+             b.runPersistent(tasks, total, cap, 0, groups, rounds), total,
+             true);
+    printRow("persistent + split>256",
+             b.runPersistent(tasks, total, cap, 256, groups, rounds), total,
+             true);
+    printf("\n");
+}
+
+// Randomized rounds with tight queues, tiny split thresholds and odd grid
+// sizes, to drive the full/empty/wrap-around paths as hard as possible.
+static int runStress(int rounds) {
+    printf("--- Vulkan queue stress (%d rounds) ---\n", rounds);
+    VkBench b;
+    Rng rng{0xC0FFEEu};
+    static const uint32_t kSplits[] = {0, 1, 2, 8, 64};
+    int failures = 0;
+    uint64_t popped = 0, pushed = 0, inlined = 0;
+
+    for (int r = 0; r < rounds; ++r) {
+        uint32_t total = 0;
+        uint32_t count = 1 + rng.next() % 4000;
+        uint32_t maxLen = (rng.next() & 1) ? 64 : 2048;
+        auto tasks = makeTasks(count, maxLen, rng, total);
+        uint32_t cap = nextPow2(count) << (rng.next() % 3);
+        uint32_t split = kSplits[rng.next() % 5];
+        uint32_t groups = 1 + rng.next() % 64;
+
+        RunResult res = b.runPersistent(tasks, total, cap, split, groups, 1);
+        popped += res.stats.dequeued;
+        pushed += res.stats.pushed;
+        inlined += res.stats.inlined;
+        if (!res.ok) {
+            ++failures;
+            printf("  round %d FAILED (tasks=%u cap=%u split=%u groups=%u)\n",
+                   r, count, cap, split, groups);
+        }
+        if ((r + 1) % 50 == 0) {
+            printf("  %d rounds, %d failures\n", r + 1, failures);
+        }
+    }
+    printf("  popped %llu, pushed by GPU %llu, inlined (queue full) %llu\n",
+           (unsigned long long)popped, (unsigned long long)pushed,
+           (unsigned long long)inlined);
+    printf("  %s\n", failures ? "STRESS FAILED" : "all rounds exactly-once");
+    return failures ? 1 : 0;
+}
+
+// ---------- CUDA ----------
+
+static void runCuda(const std::vector<Task>& tasks, uint32_t total,
+                    uint32_t rounds) {
+    printf("--- CUDA ---\n");
+    auto ctx = cuutil::createContext();
+
+    int sms = 0;
+    cuDeviceGetAttribute(&sms, CU_DEVICE_ATTRIBUTE_MULTIPROCESSOR_COUNT,
+                         ctx.device);
+    uint32_t blocks = static_cast<uint32_t>(
+        sms * std::max(1, persistent_blocks_per_sm(kBlock)));
+    uint32_t cap = nextPow2(static_cast<uint32_t>(tasks.size()) * 2);
+    printf("  persistent grid: %u blocks x %u (%d SMs, full occupancy), "
+           "queue capacity %u\n", blocks, kBlock, sms, cap);
+
+    size_t bytes = size_t(total) * 4;
+    CUdeviceptr dResults = cuutil::allocDevice(bytes);
+    CUdeviceptr dVisits = cuutil::allocDevice(bytes);
+    CUdeviceptr dQueue = cuutil::allocDevice(sizeof(QueueHeader) +
+                                             size_t(cap) * sizeof(QueueSlot));
+    auto* results = reinterpret_cast<unsigned*>(dResults);
+    auto* visits = reinterpret_cast<unsigned*>(dVisits);
+    std::vector<uint32_t> hResults(total), hVisits(total);
+
+    auto check = [&](const QueueHeader* q) {
+        cuutil::copyToHost(hResults.data(), dResults, bytes);
+        cuutil::copyToHost(hVisits.data(), dVisits, bytes);
+        return verify(hResults.data(), hVisits.data(), total, rounds, q,
+                      static_cast<uint32_t>(tasks.size()));
+    };
+
+    printHeader();
+    {
+        RunResult r;
+        cuMemsetD32(dVisits, 0, total);
+        cuCtxSynchronize();
+        auto t0 = Clock::now();
+        for (const Task& t : tasks) {
+            task_kernel<<<(t.count + kBlock - 1) / kBlock, kBlock>>>(
+                t.offset, t.count, results, visits, rounds);
+        }
+        cuCtxSynchronize();
+        r.ms = msSince(t0);
+        r.ok = check(nullptr);
+        printRow("per-task launch", r, total, false);
+    }
+
+    for (uint32_t split : {0u, 256u}) {
+        RunResult r;
+        auto q = buildQueue(tasks, cap);
+        cuutil::copyToDevice(dQueue, q.data(), q.size());
+        cuMemsetD32(dVisits, 0, total);
+        cuCtxSynchronize();
+        auto t0 = Clock::now();
+        persistent_worker<<<blocks, kBlock>>>(reinterpret_cast<void*>(dQueue),
+                                              results, visits, cap - 1, split,
+                                              rounds);
+        cuCtxSynchronize();
+        r.ms = msSince(t0);
+        cuutil::copyToHost(&r.stats, dQueue, sizeof(QueueHeader));
+        r.ok = check(&r.stats);
+        printRow(split ? "persistent + split>256" : "persistent", r, total,
+                 true);
+    }
+    printf("\n");
+
+    cuutil::freeDevice(dResults);
+    cuutil::freeDevice(dVisits);
+    cuutil::freeDevice(dQueue);
+    ctx.destroy();
+}
+
+int main(int argc, char** argv) {
+    printf("=== exp12: Persistent Threads + Lock-Free Work Queue ===\n\n");
+
+    uint32_t groups = 0;
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "--stress")) {
+            int rounds = (i + 1 < argc) ? atoi(argv[i + 1]) : 0;
+            return runStress(rounds > 0 ? rounds : 200);
+        }
+        if (!strcmp(argv[i], "--groups") && i + 1 < argc) {
+            groups = static_cast<uint32_t>(atoi(argv[++i]));
+        }
+    }
+
+    const uint32_t taskCount = 20000;
+    const uint32_t maxLen = 4096;
+    const uint32_t rounds = 16;
+    Rng rng{2024};
+    uint32_t total = 0;
+    auto tasks = makeTasks(taskCount, maxLen, rng, total);
+    printf("%u tasks, %u elements (mean %.0f, max %u per task), %u hash "
+           "rounds per element\n\n",
+           taskCount, total, double(total) / taskCount, maxLen, rounds);
+
+    runVulkan(tasks, total, rounds, groups);
+    runCuda(tasks, total, rounds);
+    return 0;
+}
@@ -0,0 +1,33 @@
+// grid_stride.cu — data[i] *= factor, one thread per element vs a
+// grid-stride loop, plus the fill kernels used for verification.
+
+extern "C" __global__ void scale_one(float* data, float factor, size_t N) {
+    size_t idx = size_t(blockIdx.x) * blockDim.x + threadIdx.x;
+    if (idx < N) data[idx] *= factor;
+}
+
+extern "C" __global__ void scale_gs(float* data, float factor, size_t N) {
+    size_t stride = size_t(gridDim.x) * blockDim.x;
+    for (size_t idx = size_t(blockIdx.x) * blockDim.x + threadIdx.x; idx < N;
+         idx += stride) {
+        data[idx] *= factor;
+    }
+}
+
+extern "C" __global__ void fill_pattern(float* data, size_t N) {
+    size_t stride = size_t(gridDim.x) * blockDim.x;
+    for (size_t idx = size_t(blockIdx.x) * blockDim.x + threadIdx.x; idx < N;
+         idx += stride) {
+        data[idx] = float(idx & 1023);
+    }
+}
+
+// Byte i holds i % 251. 251 is prime, so an index truncated to 32 bits
+// past 2^32 writes a different residue and the tail check catches it.
+extern "C" __global__ void fill_bytes(unsigned char* data, size_t N) {
+    size_t stride = size_t(gridDim.x) * blockDim.x;
+    for (size_t idx = size_t(blockIdx.x) * blockDim.x + threadIdx.x; idx < N;
+         idx += stride) {
+        data[idx] = static_cast<unsigned char>(idx % 251);
+    }
+}
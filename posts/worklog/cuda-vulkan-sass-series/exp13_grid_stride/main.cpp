@@ -0,0 +1,381 @@
+// exp13 — Grid-stride loops and 64-bit indexing for large arrays.
+// data[i] *= factor with one thread per element vs grid-stride loops at
+// fixed grid sizes, over arrays up to several GB. Vulkan binds each array
+// in windows of at most maxStorageBufferRange bytes
+// (vkutil::bindStorageBufferChunks) and dispatches once per window.
+//
+// Usage: exp13_grid_stride [--max-mb M] [--window MB] [--huge GB]
+//   --max-mb  largest array in the sweep (default 2048)
+//   --window  cap the Vulkan binding window, to force chunking on devices
+//             whose maxStorageBufferRange covers the whole array
+//   --huge    CUDA: fill a GB-sized byte array (> 2^31 elements) and check
+//             its first and last bytes
+#include "cuda_context.h"
+#include "vk_compute.h"
+#include "vk_init.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+// CUDA kernels (linked from grid_stride.cu)
+extern "C" __global__ void scale_one(float*, float, size_t);
+extern "C" __global__ void scale_gs(float*, float, size_t);
+extern "C" __global__ void fill_pattern(float*, size_t);
+extern "C" __global__ void fill_bytes(unsigned char*, size_t);
+
+using Clock = std::chrono::high_resolution_clock;
+
+static double msSince(Clock::time_point t0) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+}
+
+static std::vector<char> readFile(const std::string& path) {
+    std::ifstream f(path, std::ios::ate | std::ios::binary);
+    if (!f.is_open()) { fprintf(stderr, "Cannot open %s\n", path.c_str()); std::abort(); }
+    size_t sz = f.tellg();
+    std::vector<char> buf(sz);
+    f.seekg(0);
+    f.read(buf.data(), sz);
+    return buf;
+}
+
+static const float kFactor = 2.0f;
+
+// ~64K evenly spaced samples plus the last element, which is the one a
+// truncated index would miss. Ascending.
+static std::vector<uint64_t> samples(uint64_t n) {
+    std::vector<uint64_t> idx;
+    uint64_t step = n / 65536 + 1;
+    for (uint64_t i = 0; i < n; i += step) idx.push_back(i);
+    if (idx.back() != n - 1) idx.push_back(n - 1);
+    return idx;
+}
+
+template <typename Get>
+static bool verify(uint64_t n, Get get) {
+    auto check = [&get](uint64_t i) {
+        float want = float(i & 1023) * kFactor;
+        float got = get(i);
+        if (std::fabs(got - want) <= 1e-3f) return true;
+        fprintf(stderr, "  verify failed at %llu: %f (want %f)\n",
+                static_cast<unsigned long long>(i), got, want);
+        return false;
+    };
+    for (uint64_t i : samples(n)) {
+        if (!check(i)) return false;
+    }
+    return true;
+}
+
+static double gbPerSec(size_t bytes, double ms) {
+    return 2.0 * bytes / (ms * 1e6);  // read + write
+}
+
+static int itersFor(size_t bytes) {
+    return bytes <= (size_t(256) << 20) ? 20 : 5;
+}
+
+// ---------- Vulkan path ----------
+
+struct ScalePush {
+    float factor;
+    uint32_t N;
+};
+
+// Copy the samples() of a device-local float array into a small staging
+// buffer in one submission; returns verify()'s element getter.
+static auto readSamples(const vkutil::VkContext& ctx, VkCommandBuffer cmd,
+                        VkBuffer buf, uint64_t n) {
+    std::vector<uint64_t> idx = samples(n);
+    VkDeviceSize bytes = idx.size() * sizeof(float);
+    std::vector<VkBufferCopy> regions;
+    for (size_t k = 0; k < idx.size(); ++k) {
+        regions.push_back({idx[k] * sizeof(float), k * sizeof(float),
+                           sizeof(float)});
+    }
+    VkDeviceMemory mem;
+    VkBuffer staging = vkutil::createBuffer(
+        ctx, bytes, VK_BUFFER_USAGE_TRANSFER_DST_BIT, mem);
+    vkutil::copyBuffer(ctx, cmd, buf, staging, regions);
+
+    void* mapped;
+    vkMapMemory(ctx.device, mem, 0, bytes, 0, &mapped);
+    std::vector<float> got(idx.size());
+    std::memcpy(got.data(), mapped, bytes);
+    vkUnmapMemory(ctx.device, mem);
+    vkDestroyBuffer(ctx.device, staging, nullptr);
+    vkFreeMemory(ctx.device, mem, nullptr);
+
+    return [idx = std::move(idx), got = std::move(got)](uint64_t i) {
+        return got[std::lower_bound(idx.begin(), idx.end(), i) - idx.begin()];
+    };
+}
+
+// Group caps for the grid-stride columns; 0 = one thread per element.
+static const uint32_t kVkGroups[] = {0, 256, 1024, 4096, 16384};
+
+static void runVulkan(const std::vector<size_t>& sizes,
+                      VkDeviceSize windowBytes) {
+    printf("--- Vulkan: chunked bindings, GB/s ---\n");
+
+    auto ctx = vkutil::createComputeContext();
+    printf("  maxStorageBufferRange = %llu MB, "
+           "maxComputeWorkGroupCount[0] = %u, window = %s\n",
+           static_cast<unsigned long long>(ctx.maxStorageBufferRange >> 20),
+           ctx.maxComputeWorkGroupCountX,
+           windowBytes ? (std::to_string(windowBytes >> 20) + " MB").c_str()
+                       : "device limit");
+
+    auto spv = readFile(std::string(SPV_DIR) + "/scale.spv");
+    std::vector<uint32_t> spirv(spv.size() / sizeof(uint32_t));
+    std::memcpy(spirv.data(), spv.data(), spv.size());
+    auto kernel = vkutil::createComputeKernel(ctx, spirv, 1,
+                                              sizeof(ScalePush));
+
+    VkCommandPool pool = vkutil::createCommandPool(ctx);
+    VkCommandBuffer cmd = vkutil::allocateCommandBuffer(ctx, pool);
+    VkCommandBufferBeginInfo beginInfo{
+        VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    const uint32_t countOffset = offsetof(ScalePush, N);
+
+    // The arrays live in device-local memory. The fill pattern repeats every
+    // 1024 floats, so one host-written slab copied at slab-aligned offsets
+    // fills any size; only the verified samples are read back.
+    const VkDeviceSize slabBytes = VkDeviceSize(64) << 20;
+    VkDeviceMemory slabMem;
+    VkBuffer slab = vkutil::createBuffer(
+        ctx, slabBytes, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, slabMem);
+    void* mapped;
+    vkMapMemory(ctx.device, slabMem, 0, slabBytes, 0, &mapped);
+    float* pattern = static_cast<float*>(mapped);
+    for (uint64_t i = 0; i < slabBytes / sizeof(float); ++i) {
+        pattern[i] = float(i & 1023);
+    }
+    vkUnmapMemory(ctx.device, slabMem);
+
+    VkDeviceSize heap = 0;
+    for (uint32_t i = 0; i < ctx.memProps.memoryHeapCount; ++i) {
+        if (ctx.memProps.memoryHeaps[i].flags &
+            VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) {
+            heap = std::max(heap, ctx.memProps.memoryHeaps[i].size);
+        }
+    }
+
+    printf("  %8s | %6s | %9s", "size", "chunks", "1/elem");
+    for (size_t c = 1; c < std::size(kVkGroups); ++c) {
+        printf(" %9s", (std::to_string(kVkGroups[c]) + " grp").c_str());
+    }
+    printf("\n");
+
+    for (size_t bytes : sizes) {
+        // Leave a quarter of the heap for the driver, the display and the
+        // staging slab rather than fail the allocation.
+        if (bytes > heap / 4 * 3) {
+            printf("  %5zu MB | needs %.1f GB, device-local heap is %.1f GB "
+                   "— skipping\n",
+                   bytes >> 20, bytes / 1e9, heap / 1e9);
+            continue;
+        }
+        uint64_t n = bytes / sizeof(float);
+        VkDeviceMemory mem;
+        VkBuffer buf = vkutil::createDeviceLocalBuffer(
+            ctx, bytes,
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                VK_BUFFER_USAGE_TRANSFER_SRC_BIT |
+                VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            mem);
+        std::vector<VkBufferCopy> fill;
+        for (VkDeviceSize off = 0; off < bytes; off += slabBytes) {
+            fill.push_back({0, off, std::min(slabBytes, bytes - off)});
+        }
+        vkutil::copyBuffer(ctx, cmd, slab, buf, fill);
+
+        auto bindings = vkutil::bindStorageBufferChunks(
+            ctx, kernel, {buf}, {uint32_t(sizeof(float))}, n, windowBytes);
+
+        // Correctness: the smallest grid, so every thread loops the most
+        ScalePush pc{kFactor, 0};
+        vkBeginCommandBuffer(cmd, &beginInfo);
+        vkutil::recordChunkedDispatch(cmd, kernel, bindings, &pc, countOffset,
+                                      256, kVkGroups[1]);
+        vkEndCommandBuffer(cmd);
+        vkutil::submitAndWait(ctx, cmd);
+        bool ok = verify(n, readSamples(ctx, cmd, buf, n));
+
+        printf("  %5zu MB | %6zu |", bytes >> 20, bindings.chunks.size());
+        pc.factor = 1.0f;  // keeps the verified values stable
+        int iters = itersFor(bytes);
+        // The first chunk is the largest: one group per 256 elements
+        uint32_t oneEach = vkutil::gridStrideGroups(bindings.chunks[0].count,
+                                                    256, UINT32_MAX);
+        for (uint32_t groups : kVkGroups) {
+            if (!groups && oneEach > ctx.maxComputeWorkGroupCountX) {
+                printf(" %9s", "n/a");
+                continue;
+            }
+            uint32_t maxGroups = groups ? groups : oneEach;
+
+            vkBeginCommandBuffer(cmd, &beginInfo);
+            for (int i = 0; i < iters; ++i) {
+                if (i > 0) vkutil::recordComputeBarrier(cmd);
+                vkutil::recordChunkedDispatch(cmd, kernel, bindings, &pc,
+                                              countOffset, 256, maxGroups);
+            }
+            vkEndCommandBuffer(cmd);
+            auto t0 = Clock::now();
+            vkutil::submitAndWait(ctx, cmd);
+            printf(" %9.1f", gbPerSec(bytes, msSince(t0) / iters));
+        }
+        printf("\n");
+        if (!ok) printf("  ^ verification FAILED\n");
+
+        bindings.destroy(ctx.device);
+        vkDestroyBuffer(ctx.device, buf, nullptr);
+        vkFreeMemory(ctx.device, mem, nullptr);
+    }
+    printf("  n/a: one thread per element needs more groups than\n"
+           "  maxComputeWorkGroupCount[0] for a single window.\n\n");
+
+    vkDestroyBuffer(ctx.device, slab, nullptr);
+    vkFreeMemory(ctx.device, slabMem, nullptr);
+    vkDestroyCommandPool(ctx.device, pool, nullptr);
+    kernel.destroy(ctx.device);
+    ctx.destroy();
+}
+
+// ---------- CUDA path ----------
+
+// Grid-stride columns, in waves of resident blocks; 0 = one per element.
+static const unsigned kCudaWaves[] = {0, 1, 4, 16};
+
+static double timeScale(float* data, size_t n, unsigned grid, bool oneEach,
+                        float factor, int iters) {
+    auto t0 = Clock::now();
+    for (int i = 0; i < iters; ++i) {
+        if (oneEach) {
+            scale_one<<<grid, 256>>>(data, factor, n);
+        } else {
+            scale_gs<<<grid, 256>>>(data, factor, n);
+        }
+    }
+    cuCtxSynchronize();
+    return msSince(t0) / iters;
+}
+
+static void runCuda(const std::vector<size_t>& sizes) {
+    printf("--- CUDA: 64-bit grid-stride, GB/s ---\n");
+
+    // More elements than any wave covers, so this returns the wave itself.
+    unsigned wave = cuutil::gridStrideBlocks(size_t(1) << 48);
+    printf("  one wave = %u blocks of 256\n", wave);
+    printf("  %8s | %9s", "size", "1/elem");
+    for (size_t c = 1; c < std::size(kCudaWaves); ++c) {
+        printf(" %9s", (std::to_string(kCudaWaves[c]) + "x wave").c_str());
+    }
+    printf("\n");
+
+    for (size_t bytes : sizes) {
+        size_t n = bytes / sizeof(float);
+        CUdeviceptr d = cuutil::allocDevice(bytes);
+        float* data = reinterpret_cast<float*>(d);
+        fill_pattern<<<wave, 256>>>(data, n);
+
+        // Correctness: a single wave, so every thread loops the most
+        timeScale(data, n, wave, false, kFactor, 1);
+        bool ok = verify(n, [d](uint64_t i) {
+            float v;
+            cuutil::copyToHost(&v, d + i * sizeof(float), sizeof(float));
+            return v;
+        });
+
+        printf("  %5zu MB |", bytes >> 20);
+        int iters = itersFor(bytes);
+        for (unsigned waves : kCudaWaves) {
+            unsigned grid = waves ? wave * waves
+                                  : static_cast<unsigned>((n + 255) / 256);
+            double ms = timeScale(data, n, grid, waves == 0, 1.0f, iters);
+            printf(" %9.1f", gbPerSec(bytes, ms));
+        }
+        printf("\n");
+        if (!ok) printf("  ^ verification FAILED\n");
+        cuutil::freeDevice(d);
+    }
+    printf("\n");
+}
+
+static void runHuge(size_t bytes) {
+    printf("--- CUDA: %zu-byte array, one byte per element ---\n", bytes);
+
+    size_t freeBytes = 0, totalBytes = 0;
+    if (cuMemGetInfo(&freeBytes, &totalBytes) != CUDA_SUCCESS ||
+        freeBytes < bytes) {
+        printf("  needs %.1f GB, %.1f GB free — skipping.\n\n", bytes / 1e9,
+               freeBytes / 1e9);
+        return;
+    }
+
+    CUdeviceptr d = cuutil::allocDevice(bytes);
+    unsigned grid = cuutil::gridStrideBlocks(bytes);
+    auto t0 = Clock::now();
+    fill_bytes<<<grid, 256>>>(reinterpret_cast<unsigned char*>(d), bytes);
+    cuCtxSynchronize();
+    double ms = msSince(t0);
+
+    // Check both ends; the tail lies past 2^32 when bytes > 4 GB.
+    const size_t span = 4096;
+    std::vector<unsigned char> head(span), tail(span);
+    cuutil::copyToHost(head.data(), d, span);
+    cuutil::copyToHost(tail.data(), d + bytes - span, span);
+    bool ok = true;
+    for (size_t i = 0; i < span; ++i) {
+        ok = ok && head[i] == i % 251;
+        ok = ok && tail[i] == (bytes - span + i) % 251;
+    }
+    printf("  %u blocks, %.3f ms (%.1f GB/s write), first/last %zu bytes: "
+           "%s\n\n",
+           grid, ms, bytes / (ms * 1e6), span, ok ? "OK" : "FAILED");
+    cuutil::freeDevice(d);
+}
+
+int main(int argc, char** argv) {
+    size_t maxMb = 2048;
+    VkDeviceSize windowBytes = 0;
+    size_t hugeGb = 0;
+    for (int i = 1; i + 1 < argc; ++i) {
+        size_t value = strtoull(argv[i + 1], nullptr, 10);
+        if (!strcmp(argv[i], "--max-mb")) maxMb = value;
+        if (!strcmp(argv[i], "--window")) {
+            windowBytes = VkDeviceSize(value) << 20;
+        }
+        if (!strcmp(argv[i], "--huge")) hugeGb = value;
+    }
+
+    printf("=== exp13: Grid-Stride Loops and 64-bit Indexing ===\n\n");
+
+    std::vector<size_t> sizes;
+    for (size_t mb = 16; mb <= maxMb; mb *= 4) sizes.push_back(mb << 20);
+    if (sizes.empty() || sizes.back() != (maxMb << 20)) {
+        sizes.push_back(maxMb << 20);
+    }
+
+    runVulkan(sizes, windowBytes);
+
+    auto ctx = cuutil::createContext();
+    runCuda(sizes);
+    if (hugeGb) runHuge(hugeGb << 30);
+    ctx.destroy();
+
+    printf("GB/s counts one read + one write per element. Grid-stride rows\n"
+           "should match one-per-element once the grid covers a few waves;\n"
+           "a single wave shows the cost of the loop's extra iterations.\n");
+    return 0;
+}
@@ -0,0 +1,206 @@
+// exp14 — Vulkan context bring-up cost for short-lived processes.
+// Breaks createComputeContext down into instance / enumerate / select /
+// device, with and without the on-disk selection cache; times whole
+// processes that only bring a context up; overlaps bring-up with loading
+// input data; and shows the shared per-process context.
+//
+// Usage: exp14_context_bringup [--runs N] [--processes N]
+//        exp14_context_bringup --child [--no-cache]   (internal)
+#include "vk_init.h"
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using Clock = std::chrono::high_resolution_clock;
+
+static double msSince(Clock::time_point t0) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+}
+
+static vkutil::ContextOptions options(bool cached) {
+    vkutil::ContextOptions opts;
+    if (!cached) opts.selectionCache.clear();
+    return opts;
+}
+
+// ---------- In-process breakdown ----------
+
+static void addTiming(vkutil::BringUpTiming& sum,
+                      const vkutil::BringUpTiming& t) {
+    sum.instanceMs += t.instanceMs;
+    sum.enumerateMs += t.enumerateMs;
+    sum.selectMs += t.selectMs;
+    sum.deviceMs += t.deviceMs;
+    sum.totalMs += t.totalMs;
+}
+
+static void printRow(const char* label, const vkutil::BringUpTiming& t,
+                     int n) {
+    printf("  %-22s | %8.2f %8.2f %8.2f %8.2f | %8.2f\n", label,
+           t.instanceMs / n, t.enumerateMs / n, t.selectMs / n,
+           t.deviceMs / n, t.totalMs / n);
+}
+
+static vkutil::BringUpTiming bringUpOnce(bool cached) {
+    auto ctx = vkutil::createComputeContext(options(cached));
+    auto t = ctx.bringUp;
+    ctx.destroy();
+    return t;
+}
+
+static void measureInProcess(int runs) {
+    printf("--- In-process bring-up (ms) ---\n");
+
+    // The first instance in a process pays for loading the ICDs; a CLI job
+    // pays exactly that one. Start from an empty selection cache.
+    std::remove(vkutil::ContextOptions{}.selectionCache.c_str());
+    auto first = bringUpOnce(true);
+
+    vkutil::BringUpTiming uncached, cached;
+    bool hits = true;
+    for (int i = 0; i < runs; ++i) {
+        addTiming(uncached, bringUpOnce(false));
+        auto t = bringUpOnce(true);
+        hits = hits && t.selectionCached;
+        addTiming(cached, t);
+    }
+
+    printf("  %-22s | %8s %8s %8s %8s | %8s\n", "", "instance", "enum",
+           "select", "device", "total");
+    printRow("first (cold loader)", first, 1);
+    printRow("repeat, no cache", uncached, runs);
+    printRow("repeat, cached select", cached, runs);
+    if (!hits) printf("  ^ selection cache missed on some runs\n");
+    printf("\n");
+}
+
+// ---------- Whole processes ----------
+
+static double timeProcesses(const char* self, bool cached, int count) {
+    std::string cmd = std::string("\"") + self + "\" --child" +
+                      (cached ? "" : " --no-cache") + " > /dev/null";
+    auto t0 = Clock::now();
+    for (int i = 0; i < count; ++i) {
+        if (std::system(cmd.c_str()) != 0) {
+            fprintf(stderr, "  child process failed: %s\n", cmd.c_str());
+            return -1.0;
+        }
+    }
+    return msSince(t0) / count;
+}
+
+static void measureProcesses(const char* self, int count) {
+    printf("--- Whole process: exec + bring-up + teardown (ms) ---\n");
+    timeProcesses(self, true, 1);  // populate the cache, warm the page cache
+    double uncached = timeProcesses(self, false, count);
+    double cached = timeProcesses(self, true, count);
+    printf("  no cache:      %8.2f\n", uncached);
+    printf("  cached select: %8.2f\n", cached);
+    printf("  (%d processes each; VK_DRIVER_FILES=<one ICD json> also keeps\n"
+           "   the loader from loading drivers for other GPUs)\n\n",
+           count);
+}
+
+// ---------- Overlap with loading ----------
+
+// Stand-in for reading and parsing input: touches 256 MB on the CPU.
+static uint64_t loadInput() {
+    std::vector<uint32_t> data(64 << 20);
+    uint64_t sum = 0;
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<uint32_t>(i * 2654435761u);
+        sum += data[i] >> 7;
+    }
+    return sum;
+}
+
+static void measureOverlap() {
+    printf("--- Bring-up overlapped with input loading (ms) ---\n");
+
+    auto t0 = Clock::now();
+    uint64_t check = loadInput();
+    double loadMs = msSince(t0);
+
+    t0 = Clock::now();
+    {
+        auto ctx = vkutil::createComputeContext(options(true));
+        check ^= loadInput();
+        ctx.destroy();
+    }
+    double sequentialMs = msSince(t0);
+
+    t0 = Clock::now();
+    {
+        auto pending = vkutil::createComputeContextAsync(options(true));
+        check ^= loadInput();
+        auto ctx = pending.get();
+        ctx.destroy();
+    }
+    double overlappedMs = msSince(t0);
+
+    printf("  load alone:       %8.2f\n", loadMs);
+    printf("  bring-up, load:   %8.2f\n", sequentialMs);
+    printf("  both at once:     %8.2f   (%.2fx)\n", overlappedMs,
+           sequentialMs / overlappedMs);
+    printf("  (checksum %llx)\n\n", static_cast<unsigned long long>(check));
+}
+
+// ---------- Shared context ----------
+
+static void measureShared() {
+    printf("--- Shared per-process context (ms) ---\n");
+
+    // `owner` plays main()'s part: while it lives, later users share it.
+    auto t0 = Clock::now();
+    auto owner = vkutil::sharedComputeContext();
+    double firstMs = msSince(t0);
+
+    // Two "subsystems" that each ask for a context
+    t0 = Clock::now();
+    auto a = vkutil::sharedComputeContext();
+    auto b = vkutil::sharedComputeContext();
+    double laterMs = msSince(t0) / 2;
+
+    printf("  first acquire:    %8.2f\n", firstMs);
+    printf("  later acquires:   %8.4f   (same device: %s)\n", laterMs,
+           a->device == owner->device && b->device == owner->device ? "yes"
+                                                                    : "no");
+    printf("\n");
+}
+
+int main(int argc, char** argv) {
+    bool child = false, noCache = false;
+    int runs = 5, processes = 10;
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "--child")) child = true;
+        if (!strcmp(argv[i], "--no-cache")) noCache = true;
+        if (i + 1 < argc && !strcmp(argv[i], "--runs")) {
+            runs = atoi(argv[i + 1]);
+        }
+        if (i + 1 < argc && !strcmp(argv[i], "--processes")) {
+            processes = atoi(argv[i + 1]);
+        }
+    }
+
+    if (child) {
+        bringUpOnce(!noCache);
+        return 0;
+    }
+
+    printf("=== exp14: Vulkan Context Bring-Up ===\n\n");
+
+    measureInProcess(runs);
+    measureProcesses(argv[0], processes);
+    measureOverlap();
+    measureShared();
+
+    printf("Selection cache: %s. Every hit re-checks vendor, device and\n"
+           "driver version, so a GPU or driver change falls back to the full\n"
+           "query and rewrites it.\n",
+           vkutil::ContextOptions{}.selectionCache.c_str());
+    return 0;
+}
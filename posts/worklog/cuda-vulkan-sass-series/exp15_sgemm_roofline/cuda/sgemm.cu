@@ -0,0 +1,135 @@
+// sgemm.cu — C = A * B (row-major, M x K times K x N), three ways, plus
+// the FMA microkernel that measures peak FLOP/s.
+// Tile sizes are template parameters; glsl/ sets the same ones through
+// specialization constants. M, N and K must be multiples of the tiles.
+
+// One thread per C element; every operand comes from global memory.
+extern "C" __global__ void sgemm_naive(const float* A, const float* B,
+                                       float* C, int M, int N, int K) {
+    int row = blockIdx.y * blockDim.y + threadIdx.y;
+    int col = blockIdx.x * blockDim.x + threadIdx.x;
+    if (row >= M || col >= N) return;
+    float acc = 0.0f;
+    for (int k = 0; k < K; ++k) {
+        acc += A[size_t(row) * K + k] * B[size_t(k) * N + col];
+    }
+    C[size_t(row) * N + col] = acc;
+}
+
+// TILE x TILE threads stage TILE x TILE blocks of A and B in shared
+// memory: each global load feeds TILE FMAs.
+template <int TILE>
+__device__ void sgemmTiled(const float* A, const float* B, float* C, int N,
+                           int K) {
+    __shared__ float As[TILE][TILE];
+    __shared__ float Bs[TILE][TILE];
+    int tx = threadIdx.x, ty = threadIdx.y;
+    int row = blockIdx.y * TILE + ty;
+    int col = blockIdx.x * TILE + tx;
+
+    float acc = 0.0f;
+    for (int k0 = 0; k0 < K; k0 += TILE) {
+        As[ty][tx] = A[size_t(row) * K + k0 + tx];
+        Bs[ty][tx] = B[size_t(k0 + ty) * N + col];
+        __syncthreads();
+#pragma unroll
+        for (int k = 0; k < TILE; ++k) acc += As[ty][k] * Bs[k][tx];
+        __syncthreads();
+    }
+    C[size_t(row) * N + col] = acc;
+}
+
+// A BM x BN block of C per thread block, TM x TN of it per thread held in
+// registers. Per k step a thread loads TM + TN shared values and issues
+// TM * TN FMAs, so shared-memory traffic stops being the limit.
+template <int BM, int BN, int BK, int TM, int TN>
+__device__ void sgemmRegBlock(const float* A, const float* B, float* C,
+                              int N, int K) {
+    constexpr int kThreads = (BM / TM) * (BN / TN);
+    __shared__ float As[BK][BM];  // transposed: a k step reads a row
+    __shared__ float Bs[BK][BN];
+    int tRow = threadIdx.x / (BN / TN);
+    int tCol = threadIdx.x % (BN / TN);
+    const float* Ablk = A + size_t(blockIdx.y) * BM * K;
+    const float* Bblk = B + size_t(blockIdx.x) * BN;
+
+    float acc[TM][TN] = {};
+    float aReg[TM], bReg[TN];
+    for (int k0 = 0; k0 < K; k0 += BK) {
+        for (int i = threadIdx.x; i < BM * BK; i += kThreads) {
+            int r = i / BK, c = i % BK;
+            As[c][r] = Ablk[size_t(r) * K + k0 + c];
+        }
+        for (int i = threadIdx.x; i < BK * BN; i += kThreads) {
+            int r = i / BN, c = i % BN;
+            Bs[r][c] = Bblk[size_t(k0 + r) * N + c];
+        }
+        __syncthreads();
+#pragma unroll
+        for (int k = 0; k < BK; ++k) {
+#pragma unroll
+            for (int m = 0; m < TM; ++m) aReg[m] = As[k][tRow * TM + m];
+#pragma unroll
+            for (int n = 0; n < TN; ++n) bReg[n] = Bs[k][tCol * TN + n];
+#pragma unroll
+            for (int m = 0; m < TM; ++m) {
+#pragma unroll
+                for (int n = 0; n < TN; ++n) acc[m][n] += aReg[m] * bReg[n];
+            }
+        }
+        __syncthreads();
+    }
+
+    int row0 = blockIdx.y * BM + tRow * TM;
+    int col0 = blockIdx.x * BN + tCol * TN;
+#pragma unroll
+    for (int m = 0; m < TM; ++m) {
+#pragma unroll
+        for (int n = 0; n < TN; ++n) {
+            C[size_t(row0 + m) * N + col0 + n] = acc[m][n];
+        }
+    }
+}
+
+extern "C" __global__ void sgemm_tiled16(const float* A, const float* B,
+                                         float* C, int, int N, int K) {
+    sgemmTiled<16>(A, B, C, N, K);
+}
+
+extern "C" __global__ void sgemm_tiled32(const float* A, const float* B,
+                                         float* C, int, int N, int K) {
+    sgemmTiled<32>(A, B, C, N, K);
+}
+
+// 256 threads each
+extern "C" __global__ void sgemm_reg64(const float* A, const float* B,
+                                       float* C, int, int N, int K) {
+    sgemmRegBlock<64, 64, 8, 4, 4>(A, B, C, N, K);
+}
+
+extern "C" __global__ void sgemm_reg128(const float* A, const float* B,
+                                        float* C, int, int N, int K) {
+    sgemmRegBlock<128, 128, 8, 8, 8>(A, B, C, N, K);
+}
+
+// Eight independent FMA chains per thread hide the FMA latency; the result
+// is stored so the chains are not optimized away. 16 FLOPs per iteration.
+extern "C" __global__ void fma_peak(float* out, int iters) {
+    float a0 = threadIdx.x * 1e-3f, a1 = a0 + 1.0f, a2 = a0 + 2.0f,
+          a3 = a0 + 3.0f, a4 = a0 + 4.0f, a5 = a0 + 5.0f, a6 = a0 + 6.0f,
+          a7 = a0 + 7.0f;
+    const float b = 0.999f, c = 1e-4f;
+#pragma unroll 16
+    for (int i = 0; i < iters; ++i) {
+        a0 = fmaf(a0, b, c);
+        a1 = fmaf(a1, b, c);
+        a2 = fmaf(a2, b, c);
+        a3 = fmaf(a3, b, c);
+        a4 = fmaf(a4, b, c);
+        a5 = fmaf(a5, b, c);
+        a6 = fmaf(a6, b, c);
+        a7 = fmaf(a7, b, c);
+    }
+    out[size_t(blockIdx.x) * blockDim.x + threadIdx.x] =
+        a0 + a1 + a2 + a3 + a4 + a5 + a6 + a7;
+}
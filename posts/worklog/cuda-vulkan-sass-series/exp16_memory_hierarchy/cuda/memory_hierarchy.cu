@@ -0,0 +1,40 @@
+// memory_hierarchy.cu — pointer chase (one thread, dependent loads) and a
+// strided / random-gather read sweep over a power-of-two working set.
+
+// next[] holds a single random cycle through the working set; following it
+// makes every load wait for the previous one. cycles[0] gets the SM clock
+// ticks for the whole chase, sink[0] the final index (keeps the loads live).
+extern "C" __global__ void pointer_chase(const unsigned* next, unsigned start,
+                                         unsigned steps, unsigned* sink,
+                                         long long* cycles) {
+    unsigned p = start;
+    long long t0 = clock64();
+    for (unsigned i = 0; i < steps; ++i) p = next[p];
+    long long t1 = clock64();
+    sink[0] = p;
+    cycles[0] = t1 - t0;
+}
+
+__device__ unsigned hash32(unsigned x) {
+    x ^= x >> 16;
+    x *= 0x7feb352du;
+    x ^= x >> 15;
+    x *= 0x846ca68bu;
+    x ^= x >> 16;
+    return x;
+}
+
+// `accesses` 4-byte reads of data[(i * stride) & mask], or of a hashed
+// index when stride is 0. The XOR only keeps the loads from being removed.
+extern "C" __global__ void read_sweep(const unsigned* data, unsigned mask,
+                                      unsigned stride, size_t accesses,
+                                      unsigned* sink) {
+    size_t gstride = size_t(gridDim.x) * blockDim.x;
+    unsigned acc = 0;
+    for (size_t i = size_t(blockIdx.x) * blockDim.x + threadIdx.x;
+         i < accesses; i += gstride) {
+        unsigned j = stride ? unsigned(i) * stride : hash32(unsigned(i));
+        acc ^= data[j & mask];
+    }
+    if (acc == 0x9e3779b9u) sink[0] = acc;
+}
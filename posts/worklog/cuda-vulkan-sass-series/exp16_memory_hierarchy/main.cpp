@@ -0,0 +1,558 @@
+// exp16 — Memory latency and the cache hierarchy, on the CPU, CUDA and
+// Vulkan. A pointer chase through one random cycle gives load-to-use
+// latency for working sets from 1 KB up to --max-mb; a strided and a
+// random-gather read sweep over the same sets gives bandwidth. Plateaus in
+// the latency curve are reported as cache levels, in ns and cycles (CUDA
+// clock64, the Vulkan shader clock when VK_KHR_shader_clock is present,
+// and an estimated core clock on the CPU). On lavapipe the Vulkan rows
+// characterize the CPU caches a second time.
+//
+// Usage: exp16_memory_hierarchy [--max-mb N] [--stride B] [--no-cpu]
+//                               [--no-cuda] [--no-vulkan]
+//   --max-mb  largest working set (default 1024; capped per device)
+//   --stride  bytes between chased elements (default 128)
+#include "cuda_context.h"
+#include "shader_compiler.h"
+#include "vk_compute.h"
+#include "vk_init.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// CUDA kernels (linked from memory_hierarchy.cu)
+extern "C" __global__ void pointer_chase(const unsigned*, unsigned, unsigned,
+                                         unsigned*, long long*);
+extern "C" __global__ void read_sweep(const unsigned*, unsigned, unsigned,
+                                      size_t, unsigned*);
+
+using Clock = std::chrono::high_resolution_clock;
+
+static double msSince(Clock::time_point t0) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+}
+
+// ---------- Shared setup ----------
+
+static const uint32_t kCpuChaseSteps = 1u << 21;
+static const uint32_t kGpuChaseSteps = 1u << 18;
+static const size_t kCpuSweepAccesses = size_t(1) << 23;
+static const size_t kGpuSweepAccesses = size_t(1) << 26;
+
+struct SweepMode {
+    const char* name;
+    uint32_t strideBytes;  // 0 = random gather
+};
+
+static const SweepMode kModes[] = {
+    {"4 B stride", 4}, {"128 B stride", 128}, {"random", 0}};
+static const int kModeCount = sizeof(kModes) / sizeof(kModes[0]);
+
+struct LatencySample {
+    size_t bytes;
+    double ns;
+    double cycles;  // < 0 when the backend has no clock
+};
+
+struct BandwidthSample {
+    size_t bytes;
+    double gbps[kModeCount];  // useful bytes: 4 per access
+};
+
+struct Results {
+    std::vector<LatencySample> latency;
+    std::vector<BandwidthSample> bandwidth;
+};
+
+// Powers of two from 1 KB up to maxBytes.
+static std::vector<size_t> workingSets(size_t maxBytes) {
+    std::vector<size_t> sizes;
+    for (size_t b = 1024; b <= maxBytes; b *= 2) sizes.push_back(b);
+    return sizes;
+}
+
+static size_t floorPow2(size_t v) {
+    size_t p = 1;
+    while (p * 2 <= v) p *= 2;
+    return p;
+}
+
+// One random cycle (Sattolo's shuffle) through every `stride`-th element of
+// the first `bytes` bytes, so each load depends on the last and neither the
+// order nor the next line can be prefetched. Returns the start index.
+static uint32_t buildChain(uint32_t* next, size_t bytes, size_t strideBytes,
+                           uint64_t seed) {
+    size_t step = strideBytes / sizeof(uint32_t);
+    size_t nodes = std::max<size_t>(1, bytes / strideBytes);
+    std::vector<uint32_t> order(nodes);
+    for (size_t i = 0; i < nodes; ++i) order[i] = uint32_t(i);
+    std::mt19937_64 rng(seed);
+    for (size_t i = nodes - 1; i > 0; --i) {
+        std::swap(order[i], order[rng() % i]);
+    }
+    for (size_t i = 0; i < nodes; ++i) {
+        next[i * step] = uint32_t(order[i] * step);
+    }
+    return 0;
+}
+
+static uint32_t hash32(uint32_t x) {
+    x ^= x >> 16;
+    x *= 0x7feb352du;
+    x ^= x >> 15;
+    x *= 0x846ca68bu;
+    x ^= x >> 16;
+    return x;
+}
+
+// ---------- Level detection ----------
+
+struct Level {
+    std::string name;
+    size_t capacity;  // largest working set still on this plateau
+    double ns;
+    double cycles;
+};
+
+// A rise of more than 30% over the previous working set starts a new
+// plateau. A single point between two rises is the ramp where part of the
+// set still hits; it is skipped rather than reported as a level. The
+// plateaus are named L1, L2, ... and the last one DRAM (the LLC if
+// --max-mb does not reach past it).
+static std::vector<Level> detectLevels(const std::vector<LatencySample>& s) {
+    std::vector<std::pair<size_t, size_t>> plateaus;  // [begin, end)
+    size_t begin = 0;
+    for (size_t i = 1; i < s.size(); ++i) {
+        if (s[i].ns > 1.3 * s[i - 1].ns) {
+            if (i - begin > 1 || plateaus.empty()) {
+                plateaus.push_back({begin, i});
+            }
+            begin = i;
+        }
+    }
+    if (begin < s.size()) plateaus.push_back({begin, s.size()});
+
+    std::vector<Level> levels;
+    for (size_t k = 0; k < plateaus.size(); ++k) {
+        auto [b, e] = plateaus[k];
+        const auto& mid = s[b + (e - b) / 2];  // median working set
+        std::string name = k + 1 < plateaus.size() || k == 0
+                               ? "L" + std::to_string(k + 1)
+                               : "DRAM";
+        levels.push_back({name, s[e - 1].bytes, mid.ns, mid.cycles});
+    }
+    return levels;
+}
+
+static std::string formatBytes(size_t b) {
+    char buf[32];
+    if (b >= (size_t(1) << 30)) {
+        snprintf(buf, sizeof(buf), "%zu GB", b >> 30);
+    } else if (b >= (size_t(1) << 20)) {
+        snprintf(buf, sizeof(buf), "%zu MB", b >> 20);
+    } else {
+        snprintf(buf, sizeof(buf), "%zu KB", b >> 10);
+    }
+    return buf;
+}
+
+static void report(const char* backend, const char* clockName,
+                   const Results& r) {
+    printf("  %-10s %10s %12s | %12s %12s %12s\n", "set", "ns/load",
+           clockName, kModes[0].name, kModes[1].name, kModes[2].name);
+    for (size_t i = 0; i < r.latency.size(); ++i) {
+        const auto& l = r.latency[i];
+        printf("  %-10s %10.2f ", formatBytes(l.bytes).c_str(), l.ns);
+        if (l.cycles >= 0) {
+            printf("%12.1f |", l.cycles);
+        } else {
+            printf("%12s |", "-");
+        }
+        for (double g : r.bandwidth[i].gbps) printf(" %12.1f", g);
+        printf("\n");
+    }
+    printf("  (bandwidth in GB/s of requested bytes)\n");
+
+    printf("  %s levels:", backend);
+    for (const auto& lv : detectLevels(r.latency)) {
+        printf("  %s <= %s: %.1f ns", lv.name.c_str(),
+               formatBytes(lv.capacity).c_str(), lv.ns);
+        if (lv.cycles >= 0) printf(" / %.0f cyc", lv.cycles);
+    }
+    printf("\n\n");
+}
+
+// ---------- CPU path ----------
+
+static volatile uint32_t gSink;
+
+// Frequency of dependent single-cycle ALU ops: four per iteration, so the
+// loop's own branch is never the bottleneck.
+static double estimateCpuGHz() {
+    const uint64_t iters = uint64_t(1) << 26;
+    uint64_t x = 1;
+    auto t0 = Clock::now();
+    for (uint64_t i = 0; i < iters; ++i) {
+        x += i;
+        __asm__ volatile("" : "+r"(x));
+        x ^= i;
+        __asm__ volatile("" : "+r"(x));
+        x += i;
+        __asm__ volatile("" : "+r"(x));
+        x ^= i;
+        __asm__ volatile("" : "+r"(x));
+    }
+    double ms = msSince(t0);
+    gSink = uint32_t(x);
+    return 4.0 * iters / (ms * 1e6);
+}
+
+static uint32_t chaseCpu(const uint32_t* next, uint32_t p, uint32_t steps) {
+    for (uint32_t i = 0; i < steps; ++i) p = next[p];
+    return p;
+}
+
+static uint32_t sweepCpu(const uint32_t* data, uint32_t mask, uint32_t stride,
+                         size_t accesses) {
+    // Separate loops, so the strided one can vectorize like a real scan
+    uint32_t acc = 0;
+    if (stride) {
+        for (size_t i = 0; i < accesses; ++i) {
+            acc ^= data[(uint32_t(i) * stride) & mask];
+        }
+    } else {
+        for (size_t i = 0; i < accesses; ++i) {
+            acc ^= data[hash32(uint32_t(i)) & mask];
+        }
+    }
+    return acc;
+}
+
+static Results runCpu(size_t maxBytes, size_t strideBytes, double ghz) {
+    // Leave most of physical memory to the OS
+    size_t phys = size_t(sysconf(_SC_PHYS_PAGES)) * sysconf(_SC_PAGESIZE);
+    maxBytes = std::min(maxBytes, floorPow2(phys / 4));
+    std::vector<uint32_t> data(maxBytes / sizeof(uint32_t));
+
+    Results r;
+    for (size_t bytes : workingSets(maxBytes)) {
+        uint32_t start = buildChain(data.data(), bytes, strideBytes, bytes);
+        size_t nodes = std::max<size_t>(1, bytes / strideBytes);
+        gSink = chaseCpu(data.data(), start,
+                         uint32_t(std::min<size_t>(nodes, kCpuChaseSteps)));
+
+        double best = 1e30;
+        for (int rep = 0; rep < 3; ++rep) {
+            auto t0 = Clock::now();
+            gSink = chaseCpu(data.data(), start, kCpuChaseSteps);
+            best = std::min(best, msSince(t0));
+        }
+        double ns = best * 1e6 / kCpuChaseSteps;
+        r.latency.push_back({bytes, ns, ns * ghz});
+
+        BandwidthSample bw{bytes, {}};
+        uint32_t mask = uint32_t(bytes / sizeof(uint32_t) - 1);
+        for (int m = 0; m < kModeCount; ++m) {
+            uint32_t stride = kModes[m].strideBytes / sizeof(uint32_t);
+            double ms = 1e30;
+            for (int rep = 0; rep < 2; ++rep) {  // rep 0 warms the set
+                auto t0 = Clock::now();
+                gSink = sweepCpu(data.data(), mask, stride, kCpuSweepAccesses);
+                ms = std::min(ms, msSince(t0));
+            }
+            bw.gbps[m] = 4.0 * kCpuSweepAccesses / (ms * 1e6);
+        }
+        r.bandwidth.push_back(bw);
+    }
+    return r;
+}
+
+// ---------- CUDA path ----------
+
+static Results runCuda(size_t maxBytes, size_t strideBytes) {
+    size_t freeBytes = 0, totalBytes = 0;
+    cuMemGetInfo(&freeBytes, &totalBytes);
+    maxBytes = std::min(maxBytes, floorPow2(freeBytes / 2));
+
+    CUdeviceptr dData = cuutil::allocDevice(maxBytes);
+    CUdeviceptr dSink = cuutil::allocDevice(sizeof(uint32_t));
+    CUdeviceptr dCycles = cuutil::allocDevice(sizeof(long long));
+    auto data = reinterpret_cast<const unsigned*>(dData);
+    auto sink = reinterpret_cast<unsigned*>(dSink);
+    auto cycles = reinterpret_cast<long long*>(dCycles);
+    std::vector<uint32_t> host(maxBytes / sizeof(uint32_t));
+
+    // Launch + sync cost, subtracted from every chase
+    pointer_chase<<<1, 1>>>(data, 0, 0, sink, cycles);
+    cuCtxSynchronize();
+    auto t0 = Clock::now();
+    for (int i = 0; i < 10; ++i) {
+        pointer_chase<<<1, 1>>>(data, 0, 0, sink, cycles);
+        cuCtxSynchronize();
+    }
+    double overheadMs = msSince(t0) / 10;
+
+    Results r;
+    for (size_t bytes : workingSets(maxBytes)) {
+        uint32_t start = buildChain(host.data(), bytes, strideBytes, bytes);
+        cuutil::copyToDevice(dData, host.data(), bytes);
+        size_t nodes = std::max<size_t>(1, bytes / strideBytes);
+        unsigned warm = unsigned(std::min<size_t>(nodes, kGpuChaseSteps));
+        pointer_chase<<<1, 1>>>(data, start, warm, sink, cycles);
+        cuCtxSynchronize();
+
+        t0 = Clock::now();
+        pointer_chase<<<1, 1>>>(data, start, kGpuChaseSteps, sink, cycles);
+        cuCtxSynchronize();
+        double ms = std::max(0.0, msSince(t0) - overheadMs);
+        long long ticks = 0;
+        cuutil::copyToHost(&ticks, dCycles, sizeof(ticks));
+        r.latency.push_back({bytes, ms * 1e6 / kGpuChaseSteps,
+                             double(ticks) / kGpuChaseSteps});
+
+        BandwidthSample bw{bytes, {}};
+        unsigned mask = unsigned(bytes / sizeof(uint32_t) - 1);
+        unsigned grid = cuutil::gridStrideBlocks(kGpuSweepAccesses);
+        for (int m = 0; m < kModeCount; ++m) {
+            unsigned stride = kModes[m].strideBytes / sizeof(uint32_t);
+            read_sweep<<<grid, 256>>>(data, mask, stride, kGpuSweepAccesses,
+                                      sink);  // warmup
+            cuCtxSynchronize();
+            t0 = Clock::now();
+            for (int i = 0; i < 4; ++i) {
+                read_sweep<<<grid, 256>>>(data, mask, stride,
+                                          kGpuSweepAccesses, sink);
+            }
+            cuCtxSynchronize();
+            bw.gbps[m] = 4.0 * kGpuSweepAccesses / (msSince(t0) / 4 * 1e6);
+        }
+        r.bandwidth.push_back(bw);
+    }
+    cuutil::freeDevice(dData);
+    cuutil::freeDevice(dSink);
+    cuutil::freeDevice(dCycles);
+    return r;
+}
+
+// ---------- Vulkan path ----------
+
+struct VkBench {
+    vkutil::VkContext ctx;
+    vkutil::ComputeKernel chase;
+    vkutil::ComputeKernel sweep;
+    VkCommandPool pool = VK_NULL_HANDLE;
+    VkCommandBuffer cmd = VK_NULL_HANDLE;
+
+    VkBench() : ctx(vkutil::createComputeContext()) {
+        vkutil::ShaderCompiler compiler("spv_cache");
+        std::string dir = GLSL_DIR;
+        vkutil::ShaderDefines defines;
+        if (ctx.hasShaderClock) defines.push_back({"HAS_SHADER_CLOCK", "1"});
+        chase = vkutil::createComputeKernel(
+            ctx, compiler.compileFile(dir + "/pointer_chase.comp", defines),
+            2, 2 * sizeof(uint32_t));
+        sweep = vkutil::createComputeKernel(
+            ctx, compiler.compileFile(dir + "/read_sweep.comp"), 2,
+            3 * sizeof(uint32_t));
+        pool = vkutil::createCommandPool(ctx);
+        cmd = vkutil::allocateCommandBuffer(ctx, pool);
+    }
+
+    ~VkBench() {
+        vkDestroyCommandPool(ctx.device, pool, nullptr);
+        chase.destroy(ctx.device);
+        sweep.destroy(ctx.device);
+        ctx.destroy();
+    }
+
+    void begin() {
+        VkCommandBufferBeginInfo beginInfo{
+            VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        vkBeginCommandBuffer(cmd, &beginInfo);
+    }
+
+    double submit() {
+        vkEndCommandBuffer(cmd);
+        auto t0 = Clock::now();
+        vkutil::submitAndWait(ctx, cmd);
+        return msSince(t0);
+    }
+
+    // Largest working set the device can bind and hold next to a staging
+    // copy: a power of two within maxStorageBufferRange and half the
+    // biggest device-local heap.
+    size_t capacity(size_t maxBytes) const {
+        VkDeviceSize heap = 0;
+        for (uint32_t i = 0; i < ctx.memProps.memoryHeapCount; ++i) {
+            if (ctx.memProps.memoryHeaps[i].flags &
+                VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) {
+                heap = std::max(heap, ctx.memProps.memoryHeaps[i].size);
+            }
+        }
+        size_t cap = std::min<size_t>(ctx.maxStorageBufferRange, heap / 2);
+        return std::min(maxBytes, floorPow2(cap));
+    }
+};
+
+static Results runVulkan(VkBench& vk, size_t maxBytes, size_t strideBytes) {
+    const auto& ctx = vk.ctx;
+    maxBytes = vk.capacity(maxBytes);
+
+    // The chain is built in a mapped staging buffer and copied into
+    // device-local memory, so the chase does not measure PCIe.
+    VkDeviceMemory dataMem, stagingMem, outMem;
+    VkBuffer data = vkutil::createDeviceLocalBuffer(
+        ctx, maxBytes,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        dataMem);
+    VkBuffer staging = vkutil::createBuffer(
+        ctx, maxBytes, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, stagingMem);
+    VkBuffer out = vkutil::createBuffer(
+        ctx, 4 * sizeof(uint32_t), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, outMem);
+    void* mapped;
+    vkMapMemory(ctx.device, stagingMem, 0, maxBytes, 0, &mapped);
+    auto host = static_cast<uint32_t*>(mapped);
+    void* outMapped;
+    vkMapMemory(ctx.device, outMem, 0, 4 * sizeof(uint32_t), 0, &outMapped);
+    auto result = static_cast<const uint32_t*>(outMapped);
+
+    vkutil::bindStorageBuffers(ctx, vk.chase, {data, out});
+    vkutil::bindStorageBuffers(ctx, vk.sweep, {data, out});
+
+    // Submit + fence wait cost, subtracted from every chase
+    uint32_t empty[2] = {0, 0};
+    double overheadMs = 0;
+    for (int i = 0; i < 11; ++i) {
+        vk.begin();
+        vkutil::recordDispatch(vk.cmd, vk.chase, empty, 1);
+        double ms = vk.submit();
+        if (i > 0) overheadMs += ms / 10;  // i 0 warms up
+    }
+
+    Results r;
+    for (size_t bytes : workingSets(maxBytes)) {
+        uint32_t start = buildChain(host, bytes, strideBytes, bytes);
+        size_t nodes = std::max<size_t>(1, bytes / strideBytes);
+        uint32_t warm[2] = {start,
+                            uint32_t(std::min<size_t>(nodes, kGpuChaseSteps))};
+
+        vk.begin();
+        VkBufferCopy region{0, 0, bytes};
+        vkCmdCopyBuffer(vk.cmd, staging, data, 1, &region);
+        VkMemoryBarrier barrier{VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        vkCmdPipelineBarrier(vk.cmd, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1,
+                             &barrier, 0, nullptr, 0, nullptr);
+        vkutil::recordDispatch(vk.cmd, vk.chase, warm, 1);
+        vk.submit();
+
+        uint32_t timed[2] = {start, kGpuChaseSteps};
+        vk.begin();
+        vkutil::recordDispatch(vk.cmd, vk.chase, timed, 1);
+        double ms = std::max(0.0, vk.submit() - overheadMs);
+        uint64_t ticks = result[1] | uint64_t(result[2]) << 32;
+        r.latency.push_back({bytes, ms * 1e6 / kGpuChaseSteps,
+                             ctx.hasShaderClock
+                                 ? double(ticks) / kGpuChaseSteps
+                                 : -1.0});
+
+        BandwidthSample bw{bytes, {}};
+        uint32_t groups = vkutil::gridStrideGroups(kGpuSweepAccesses);
+        for (int m = 0; m < kModeCount; ++m) {
+            uint32_t push[3] = {uint32_t(bytes / sizeof(uint32_t) - 1),
+                                kModes[m].strideBytes / 4,
+                                uint32_t(kGpuSweepAccesses)};
+            vk.begin();
+            vkutil::recordDispatch(vk.cmd, vk.sweep, push, groups);  // warmup
+            vk.submit();
+            vk.begin();
+            for (int i = 0; i < 4; ++i) {
+                vkutil::recordDispatch(vk.cmd, vk.sweep, push, groups);
+            }
+            bw.gbps[m] = 4.0 * kGpuSweepAccesses / (vk.submit() / 4 * 1e6);
+        }
+        r.bandwidth.push_back(bw);
+    }
+
+    vkUnmapMemory(ctx.device, stagingMem);
+    vkUnmapMemory(ctx.device, outMem);
+    for (auto [b, m] : {std::make_pair(data, dataMem),
+                        std::make_pair(staging, stagingMem),
+                        std::make_pair(out, outMem)}) {
+        vkDestroyBuffer(ctx.device, b, nullptr);
+        vkFreeMemory(ctx.device, m, nullptr);
+    }
+    return r;
+}
+
+int main(int argc, char** argv) {
+    size_t maxMB = 1024, strideBytes = 128;
+    bool cpu = true, cuda = true, vulkan = true;
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "--no-cpu")) cpu = false;
+        if (!strcmp(argv[i], "--no-cuda")) cuda = false;
+        if (!strcmp(argv[i], "--no-vulkan")) vulkan = false;
+        if (i + 1 < argc && !strcmp(argv[i], "--max-mb")) {
+            maxMB = strtoull(argv[i + 1], nullptr, 10);
+        }
+        if (i + 1 < argc && !strcmp(argv[i], "--stride")) {
+            strideBytes = strtoull(argv[i + 1], nullptr, 10);
+        }
+    }
+    // Powers of two, so the sweeps can mask and every chained element is
+    // aligned; elements are addressed with 32-bit indices.
+    strideBytes = floorPow2(std::max<size_t>(strideBytes, 4));
+    size_t maxBytes = std::min(floorPow2(std::max<size_t>(maxMB, 1) << 20),
+                               size_t(1) << 33);
+
+    printf("=== exp16: Memory Latency and Cache Hierarchy ===\n");
+    printf("Working sets 1 KB .. %s, chase stride %zu B\n\n",
+           formatBytes(maxBytes).c_str(), strideBytes);
+
+    if (cpu) {
+        double ghz = estimateCpuGHz();
+        printf("--- CPU (one thread) ---\n");
+        printf("  core clock (dependent ALU ops): %.2f GHz", ghz);
+#if defined(__x86_64__) || defined(__i386__)
+        auto t0 = Clock::now();
+        uint64_t tsc0 = __rdtsc();
+        while (msSince(t0) < 100) {}
+        double tscGHz = (__rdtsc() - tsc0) / (msSince(t0) * 1e6);
+        printf(", TSC: %.2f GHz", tscGHz);
+#endif
+        printf("\n");
+        report("CPU", "cycles", runCpu(maxBytes, strideBytes, ghz));
+    }
+
+    if (cuda) {
+        auto ctx = cuutil::createContext();
+        printf("--- CUDA (chase: one thread; cycles from clock64) ---\n");
+        report("CUDA", "SM cycles", runCuda(maxBytes, strideBytes));
+        ctx.destroy();
+    }
+
+    if (vulkan) {
+        VkBench vk;
+        printf("--- Vulkan (chase: one invocation; %s) ---\n",
+               vk.ctx.hasShaderClock ? "ticks from the shader clock"
+                                     : "no VK_KHR_shader_clock");
+        report("Vulkan", "clock ticks", runVulkan(vk, maxBytes, strideBytes));
+    }
+
+    printf("Latency is wall time per dependent load with launch/submit cost\n"
+           "removed. Past the last cache it also includes TLB misses.\n");
+    return 0;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <type_traits>
+
+namespace apitrace {
+
+/// Opt-in tracer for vk*/cu* calls made through API_TRACE / VK_CHECK /
+/// CU_CHECK, i.e. inside shared_lib and wherever an experiment wraps a call
+/// itself. Enabled by SASS_API_TRACE=1 at startup or setEnabled(true).
+/// When disabled a traced call costs one relaxed load and a branch.
+/// To trace every exported vk*/cu* call of an unmodified binary instead,
+/// LD_PRELOAD libapi_trace_preload.so (see api_trace_preload.cpp).
+extern std::atomic<bool> gEnabled;
+
+inline bool enabled() { return gEnabled.load(std::memory_order_relaxed); }
+void setEnabled(bool on);
+
+/// Monotonic clock in nanoseconds.
+uint64_t nowNs();
+
+/// Append one event to the calling thread's buffer. Lock-free except when a
+/// thread starts a new chunk. `name` must outlive the tracer (a literal).
+void record(const char* name, uint64_t startNs, uint64_t endNs);
+
+/// Per-call count / total / mean / max, sorted by total time.
+void dumpSummary(FILE* out = stderr);
+
+/// Chrome trace-event JSON, loadable in Perfetto or chrome://tracing.
+bool writeChromeTrace(const std::string& path);
+
+/// Drop all recorded events. Only call while no other thread is tracing.
+void reset();
+
+template <typename F>
+inline auto traced(const char* name, F&& f) -> decltype(f()) {
+    if (!enabled()) return f();
+    uint64_t t0 = nowNs();
+    if constexpr (std::is_void_v<decltype(f())>) {
+        f();
+        record(name, t0, nowNs());
+    } else {
+        auto r = f();
+        record(name, t0, nowNs());
+        return r;
+    }
+}
+
+}  // namespace apitrace
+
+/// Time and count one API call, e.g. API_TRACE(vkGetDeviceQueue(...)).
+/// The call text is recorded; reports group by the name before '('.
+#define API_TRACE(call) ::apitrace::traced(#call, [&] { return call; })
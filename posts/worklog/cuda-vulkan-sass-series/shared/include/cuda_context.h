@@ -34,4 +34,16 @@ void copyToDevice(CUdeviceptr dst, const void* src, size_t bytes);
 /// Copy device → host.
 void copyToHost(void* dst, CUdeviceptr src, size_t bytes);
 
+/// Page-lock an existing host allocation and map it into the device address
+/// space (cuMemHostRegister). Kernels access it in place over the bus.
+CUdeviceptr registerHost(void* ptr, size_t bytes);
+
+/// Undo registerHost().
+void unregisterHost(void* ptr);
+
+/// Blocks for a grid-stride kernel over `n` elements on the current
+/// context's device: one per `blockSize` elements, capped at one full wave
+/// (SMs x max resident threads per SM / blockSize).
+unsigned gridStrideBlocks(size_t n, unsigned blockSize = 256);
+
 }  // namespace cuutil
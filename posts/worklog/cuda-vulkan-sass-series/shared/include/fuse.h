@@ -0,0 +1,258 @@
+#pragma once
+
+// Expression-template fusion for element-wise float chains.
+//
+//   fuse::Buffer A{0}, B{1};
+//   auto f = fuse::lower((A + B) * 0.5f);
+//   vkFuser.record(cmd, f, vkFuser.bind(f, out, {bufA, bufB}), N);
+//   cuFuser.launch(f, dOut, {dA, dB}, N);
+//   fuse::evalCpu((A + B) * 0.5f, out, {a, b}, N);
+//
+// Each backend compiles one kernel per expression *shape*: kernels are cached
+// by the lowered text, which names inputs by order of first use and passes
+// scalars as parameters. Binding other arrays or changing a constant reuses
+// the compiled kernel.
+
+#include "cuda_context.h"
+#include "shader_compiler.h"
+#include "vk_compute.h"
+#include "vk_init.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace fuse {
+
+/// Handle to a float array. `slot` indexes the array list passed at
+/// dispatch time; the same handle may appear several times in an expression.
+struct Buffer {
+    int slot;
+};
+
+/// A float constant, passed as a kernel parameter rather than baked in.
+struct Scalar {
+    float value;
+};
+
+enum class Op { Add, Sub, Mul, Div };
+
+template <Op O, typename L, typename R>
+struct Binary {
+    L lhs;
+    R rhs;
+};
+
+template <typename T> struct IsExpr : std::false_type {};
+template <> struct IsExpr<Buffer> : std::true_type {};
+template <> struct IsExpr<Scalar> : std::true_type {};
+template <Op O, typename L, typename R>
+struct IsExpr<Binary<O, L, R>> : std::true_type {};
+
+namespace detail {
+
+template <typename T>
+using AsExpr = std::conditional_t<std::is_arithmetic_v<T>, Scalar, T>;
+
+template <typename T>
+AsExpr<T> asExpr(const T& v) {
+    if constexpr (std::is_arithmetic_v<T>) {
+        return Scalar{static_cast<float>(v)};
+    } else {
+        return v;
+    }
+}
+
+// At least one side is an expression; the other may be a plain number.
+template <typename L, typename R>
+constexpr bool kOperands =
+    (IsExpr<L>::value || IsExpr<R>::value) &&
+    (IsExpr<L>::value || std::is_arithmetic_v<L>) &&
+    (IsExpr<R>::value || std::is_arithmetic_v<R>);
+
+}  // namespace detail
+
+#define FUSE_BINARY_OPERATOR(SYM, OP)                                        \
+    template <typename L, typename R,                                        \
+              typename = std::enable_if_t<detail::kOperands<L, R>>>          \
+    Binary<Op::OP, detail::AsExpr<L>, detail::AsExpr<R>> operator SYM(       \
+        const L& l, const R& r) {                                            \
+        return {detail::asExpr(l), detail::asExpr(r)};                       \
+    }
+FUSE_BINARY_OPERATOR(+, Add)
+FUSE_BINARY_OPERATOR(-, Sub)
+FUSE_BINARY_OPERATOR(*, Mul)
+FUSE_BINARY_OPERATOR(/, Div)
+#undef FUSE_BINARY_OPERATOR
+
+// ---------- CPU backend ----------
+
+inline float evalAt(const Buffer& b, const float* const* in, size_t i) {
+    return in[b.slot][i];
+}
+
+inline float evalAt(const Scalar& s, const float* const*, size_t) {
+    return s.value;
+}
+
+template <Op O, typename L, typename R>
+inline float evalAt(const Binary<O, L, R>& e, const float* const* in,
+                    size_t i) {
+    float a = evalAt(e.lhs, in, i);
+    float b = evalAt(e.rhs, in, i);
+    if constexpr (O == Op::Add) return a + b;
+    if constexpr (O == Op::Sub) return a - b;
+    if constexpr (O == Op::Mul) return a * b;
+    if constexpr (O == Op::Div) return a / b;
+}
+
+/// out[i] = e(i) for i < n, with `in` indexed by Buffer::slot. The whole
+/// tree inlines into one loop the compiler can vectorize. `out` may alias
+/// an input: every element only reads its own index.
+template <typename E>
+void evalCpu(const E& e, float* out, const std::vector<const float*>& in,
+             size_t n) {
+    const float* const* p = in.data();
+#if defined(__GNUC__)
+#pragma GCC ivdep
+#endif
+    for (size_t i = 0; i < n; ++i) out[i] = evalAt(e, p, i);
+}
+
+// ---------- Lowering ----------
+
+/// An expression flattened for code generation.
+struct Fused {
+    std::string expr;            // body over x<k> (inputs) and s<k> (scalars);
+                                 // fixes the emitted source: the cache key
+    std::vector<int> slots;      // input x<k> reads array slots[k]
+    std::vector<float> scalars;  // values of s<k>
+    int ops = 0;                 // arithmetic operations
+    uint64_t hash = 0;           // of `expr`: names the generated source
+
+    /// Bytes read and written per element (each input once, plus output).
+    size_t bytesPerElement() const { return 4 * (slots.size() + 1); }
+};
+
+namespace detail {
+
+inline void lowerInto(const Buffer& b, Fused& f) {
+    size_t k = 0;
+    while (k < f.slots.size() && f.slots[k] != b.slot) ++k;
+    if (k == f.slots.size()) f.slots.push_back(b.slot);
+    f.expr += "x" + std::to_string(k);
+}
+
+inline void lowerInto(const Scalar& s, Fused& f) {
+    f.expr += "s" + std::to_string(f.scalars.size());
+    f.scalars.push_back(s.value);
+}
+
+template <Op O, typename L, typename R>
+void lowerInto(const Binary<O, L, R>& e, Fused& f) {
+    static const char kSym[] = {'+', '-', '*', '/'};
+    f.expr += '(';
+    lowerInto(e.lhs, f);
+    f.expr += ' ';
+    f.expr += kSym[static_cast<int>(O)];
+    f.expr += ' ';
+    lowerInto(e.rhs, f);
+    f.expr += ')';
+    ++f.ops;
+}
+
+}  // namespace detail
+
+template <typename E>
+Fused lower(const E& e) {
+    static_assert(IsExpr<E>::value, "fuse::lower needs a fuse expression");
+    Fused f;
+    detail::lowerInto(e, f);
+    f.hash = vkutil::hashBytes(f.expr.data(), f.expr.size());
+    return f;
+}
+
+// ---------- Code generation ----------
+
+/// GLSL compute shader for `f`: binding 0 is the output, bindings 1..K the
+/// inputs; push constants are { uint N; float s0..; }. Grid-stride loop.
+std::string emitGlsl(const Fused& f);
+
+/// CUDA C++ for `f`: extern "C" fused(float* out, const float* in0..,
+/// float s0.., size_t N). Grid-stride loop.
+std::string emitCuda(const Fused& f);
+
+// ---------- Vulkan backend ----------
+
+/// Compiles fused kernels through ShaderCompiler (so the SPIR-V also lands
+/// in its disk cache) and hands out descriptor sets from its own pool, so
+/// one kernel can be bound to different arrays within a command buffer.
+class VkFuser {
+public:
+    VkFuser(const vkutil::VkContext& ctx, vkutil::ShaderCompiler& compiler,
+            uint32_t maxBindings = 256);
+    ~VkFuser();
+    VkFuser(const VkFuser&) = delete;
+    VkFuser& operator=(const VkFuser&) = delete;
+
+    /// Descriptor set for `f` writing `out` and reading `arrays` (indexed by
+    /// Buffer::slot). Compiles the kernel on first use of this shape.
+    VkDescriptorSet bind(const Fused& f, VkBuffer out,
+                         const std::vector<VkBuffer>& arrays);
+
+    /// Record push constants + dispatch over N elements. Sets from bind()
+    /// cover whole buffers, so N is bounded by maxStorageBufferRange.
+    void record(VkCommandBuffer cmd, const Fused& f, VkDescriptorSet set,
+                uint32_t N);
+
+    /// Return every set from bind() to the pool. The GPU must be idle.
+    void resetBindings();
+
+    size_t kernelCount() const { return kernels_.size(); }
+    double compileMs() const { return compileMs_; }
+
+private:
+    const vkutil::ComputeKernel& kernel(const Fused& f);
+
+    const vkutil::VkContext& ctx_;
+    vkutil::ShaderCompiler& compiler_;
+    VkDescriptorPool pool_ = VK_NULL_HANDLE;
+    std::unordered_map<std::string, vkutil::ComputeKernel> kernels_;
+    double compileMs_ = 0.0;
+};
+
+// ---------- CUDA backend ----------
+
+/// Compiles fused kernels with NVRTC for the current context's device. The
+/// driver's own JIT cache (~/.nv/ComputeCache) covers the PTX → SASS step.
+class CuFuser {
+public:
+    CuFuser();
+    ~CuFuser();
+    CuFuser(const CuFuser&) = delete;
+    CuFuser& operator=(const CuFuser&) = delete;
+
+    /// Launch `f` writing `out` and reading `arrays` (indexed by
+    /// Buffer::slot). Compiles the kernel on first use of this shape.
+    void launch(const Fused& f, CUdeviceptr out,
+                const std::vector<CUdeviceptr>& arrays, size_t N,
+                CUstream stream = nullptr);
+
+    size_t kernelCount() const { return kernels_.size(); }
+    double compileMs() const { return compileMs_; }
+
+private:
+    struct Entry {
+        CUmodule module = nullptr;
+        CUfunction function = nullptr;
+    };
+    CUfunction function(const Fused& f);
+
+    std::string arch_;
+    std::unordered_map<std::string, Entry> kernels_;
+    double compileMs_ = 0.0;
+};
+
+}  // namespace fuse
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace hostutil {
+
+/// A host allocation suitable for zero-copy import: page-aligned, with a
+/// size rounded up to the import alignment. Either heap- or file-backed.
+struct HostBuffer {
+    void* data = nullptr;
+    size_t bytes = 0;
+    bool fileBacked = false;
+
+    void release();
+};
+
+/// System page size.
+size_t pageSize();
+
+/// Round `value` up to a multiple of `alignment` (a power of two).
+inline size_t roundUp(size_t value, size_t alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+/// Allocate `bytes` (rounded up) aligned to max(alignment, page size).
+HostBuffer allocAligned(size_t bytes, size_t alignment = 0);
+
+/// mmap a file read/write, creating or resizing it to `bytes` (rounded up
+/// to the page size). Changes made by kernels land in the page cache.
+HostBuffer mapFile(const std::string& path, size_t bytes);
+
+}  // namespace hostutil
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace vkutil {
+
+/// `#define NAME VALUE` pairs injected ahead of the shader source.
+using ShaderDefines = std::vector<std::pair<std::string, std::string>>;
+
+/// 64-bit FNV-1a hash, used for cache keys.
+uint64_t hashBytes(const void* data, size_t size,
+                   uint64_t seed = 0xcbf29ce484222325ull);
+
+/// Runtime GLSL → SPIR-V compiler (shaderc) with an on-disk SPIR-V cache.
+/// The cache key covers the source text, every file it #includes, the
+/// defines and the target environment, so a hit never touches the compiler.
+class ShaderCompiler {
+public:
+    explicit ShaderCompiler(std::string cacheDir = "spv_cache");
+
+    /// Compile a compute shader from a file. Relative #include "..." paths
+    /// are resolved against the including file's directory.
+    /// Throws std::runtime_error with the compiler log on failure.
+    std::vector<uint32_t> compileFile(const std::string& path,
+                                      const ShaderDefines& defines = {});
+
+    /// Compile compute shader source held in memory. `name` is used for
+    /// diagnostics and as the base for relative #include paths.
+    std::vector<uint32_t> compileSource(const std::string& source,
+                                        const std::string& name,
+                                        const ShaderDefines& defines = {});
+
+    /// Files read by the last compile: the source itself plus its includes.
+    /// Feed these to a FileWatcher to hot-reload on edits.
+    const std::vector<std::string>& lastDependencies() const { return deps_; }
+
+    /// Whether the last compile was served from the disk cache.
+    bool lastWasCacheHit() const { return lastHit_; }
+
+    uint32_t cacheHits() const { return hits_; }
+    uint32_t cacheMisses() const { return misses_; }
+
+private:
+    std::string cacheDir_;
+    std::vector<std::string> deps_;
+    bool lastHit_ = false;
+    uint32_t hits_ = 0;
+    uint32_t misses_ = 0;
+};
+
+/// Watches source files for modification. Uses inotify on Linux (watching
+/// the parent directories, so editors that save via rename are caught) and
+/// falls back to polling modification times elsewhere.
+class FileWatcher {
+public:
+    FileWatcher();
+    ~FileWatcher();
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    /// Start watching a file. Watching the same file twice is a no-op.
+    void watch(const std::string& path);
+
+    /// Stop watching everything (e.g. before re-adding a new dependency set).
+    void clear();
+
+    /// Non-blocking: return the watched files changed since the last call.
+    std::vector<std::string> poll();
+
+private:
+    struct Entry {
+        std::string path;
+        std::string name;   // file name within its directory
+        int wd = -1;        // inotify watch descriptor (directory)
+        int64_t mtime = 0;  // last seen modification time (polling mode)
+    };
+    std::vector<Entry> entries_;
+    int fd_ = -1;
+};
+
+}  // namespace vkutil
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "vk_init.h"
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <vector>
+
+namespace vkutil {
+
+/// A compute pipeline plus everything needed to dispatch it: N storage
+/// buffers at bindings 0..N-1 and an optional push-constant block.
+struct ComputeKernel {
+    VkShaderModule module = VK_NULL_HANDLE;
+    VkDescriptorSetLayout setLayout = VK_NULL_HANDLE;
+    VkPipelineLayout layout = VK_NULL_HANDLE;
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+    VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+    uint32_t bufferCount = 0;
+    uint32_t pushConstantSize = 0;
+
+    void destroy(VkDevice device);
+};
+
+/// 32-bit specialization constants by `constant_id` (local_size_*_id
+/// included), for tuning one SPIR-V module into several pipelines.
+struct SpecConstants {
+    std::vector<VkSpecializationMapEntry> entries;
+    std::vector<uint32_t> values;
+    VkSpecializationInfo info{};
+
+    SpecConstants& set(uint32_t id, uint32_t value);
+    SpecConstants& set(uint32_t id, float value);
+
+    /// Points into this object: valid until the next set().
+    const VkSpecializationInfo* get();
+};
+
+/// Build a compute kernel from SPIR-V with `bufferCount` storage-buffer
+/// bindings and `pushConstantSize` bytes of push constants, optionally
+/// specialized.
+ComputeKernel createComputeKernel(
+    const VkContext& ctx, const std::vector<uint32_t>& spirv,
+    uint32_t bufferCount, uint32_t pushConstantSize,
+    VkPipelineCache cache = VK_NULL_HANDLE,
+    const VkSpecializationInfo* specialization = nullptr);
+
+/// Swap in new SPIR-V, keeping the layout and descriptor set (hot reload).
+/// The caller must ensure the old pipeline is no longer in flight.
+void reloadComputeKernel(const VkContext& ctx, ComputeKernel& kernel,
+                         const std::vector<uint32_t>& spirv,
+                         VkPipelineCache cache = VK_NULL_HANDLE,
+                         const VkSpecializationInfo* specialization = nullptr);
+
+/// Point bindings 0..N-1 at the given buffers (whole range).
+void bindStorageBuffers(const VkContext& ctx, const ComputeKernel& kernel,
+                        const std::vector<VkBuffer>& buffers);
+
+/// Record bind + push constants + vkCmdDispatch into `cmd`.
+void recordDispatch(VkCommandBuffer cmd, const ComputeKernel& kernel,
+                    const void* pushData, uint32_t groupsX,
+                    uint32_t groupsY = 1, uint32_t groupsZ = 1);
+
+/// Like recordDispatch, but the group counts are read on the GPU from a
+/// VkDispatchIndirectCommand at `offset` in `indirectBuffer`.
+void recordDispatchIndirect(VkCommandBuffer cmd, const ComputeKernel& kernel,
+                            const void* pushData, VkBuffer indirectBuffer,
+                            VkDeviceSize offset = 0);
+
+/// Record a shader-write → shader-read/write barrier between dispatches.
+void recordComputeBarrier(VkCommandBuffer cmd);
+
+// ---------- Large arrays ----------
+
+/// Workgroups for a grid-stride kernel over `n` elements: one per
+/// `localSize` elements, capped at `maxGroups` (65535 is the spec minimum
+/// for maxComputeWorkGroupCount[0], so the default is always legal).
+uint32_t gridStrideGroups(uint64_t n, uint32_t localSize = 256,
+                          uint32_t maxGroups = 65535);
+
+/// One window of a dispatch over arrays too large for a single binding.
+struct DispatchChunk {
+    uint64_t first;  // first element of the window
+    uint32_t count;  // elements in the window
+};
+
+/// A kernel's buffers bound once per window, at 64-bit descriptor offsets,
+/// so arrays beyond maxStorageBufferRange are processed chunk by chunk.
+struct ChunkedBindings {
+    VkDescriptorPool pool = VK_NULL_HANDLE;
+    std::vector<VkDescriptorSet> sets;  // one per chunk
+    std::vector<DispatchChunk> chunks;
+
+    void destroy(VkDevice device);
+};
+
+/// Bind `buffers[k]`, an array of `n` elements of `elemSizes[k]` bytes, to
+/// binding k, split into windows no larger than `maxWindowBytes` for any
+/// binding (0 = ctx.maxStorageBufferRange). Windows start on
+/// minStorageBufferOffsetAlignment boundaries.
+ChunkedBindings bindStorageBufferChunks(const VkContext& ctx,
+                                        const ComputeKernel& kernel,
+                                        const std::vector<VkBuffer>& buffers,
+                                        const std::vector<uint32_t>& elemSizes,
+                                        uint64_t n,
+                                        VkDeviceSize maxWindowBytes = 0);
+
+/// Record one dispatch per chunk. `pushData` is the kernel's push block;
+/// the chunk's element count is written as a uint32 at `countOffset` bytes
+/// into it, so an unmodified `uint N` kernel only sees its own window.
+void recordChunkedDispatch(VkCommandBuffer cmd, const ComputeKernel& kernel,
+                           const ChunkedBindings& bindings,
+                           const void* pushData, uint32_t countOffset,
+                           uint32_t localSize = 256,
+                           uint32_t maxGroups = 65535);
+
+}  // namespace vkutil
@@ -1,11 +1,23 @@
 #pragma once
 
 #include <vulkan/vulkan.h>
+#include <future>
+#include <memory>
 #include <string>
 #include <vector>
 
 namespace vkutil {
 
+/// Wall-clock breakdown of one context bring-up, in milliseconds.
+struct BringUpTiming {
+    double instanceMs = 0;   // vkCreateInstance (loader + ICD load)
+    double enumerateMs = 0;  // vkEnumeratePhysicalDevices
+    double selectMs = 0;     // properties, extensions, features, queues
+    double deviceMs = 0;     // vkCreateDevice + vkGetDeviceQueue
+    double totalMs = 0;
+    bool selectionCached = false;  // selectMs served from the disk cache
+};
+
 /// Vulkan compute context — instance, physical device, logical device, queue.
 struct VkContext {
     VkInstance instance = VK_NULL_HANDLE;
@@ -15,21 +27,93 @@ struct VkContext {
     uint32_t computeQueueFamily = 0;
     VkPhysicalDeviceMemoryProperties memProps{};
 
+    // Limits that decide how large arrays are bound and dispatched
+    VkDeviceSize maxStorageBufferRange = 0;           // bytes per binding
+    VkDeviceSize minStorageBufferOffsetAlignment = 0;
+    uint32_t maxComputeWorkGroupCountX = 0;
+
+    // VK_EXT_external_memory_host (enabled automatically when supported)
+    bool hasExternalMemoryHost = false;
+    VkDeviceSize minImportedHostPointerAlignment = 0;
+
+    // Reduced-precision storage/arithmetic (Vulkan 1.2 core features,
+    // enabled automatically when supported)
+    bool hasStorage16 = false;  // storageBuffer16BitAccess
+    bool hasStorage8 = false;   // storageBuffer8BitAccess
+    bool hasFloat16 = false;    // shaderFloat16
+    bool hasInt8 = false;       // shaderInt8
+
+    bool hasPipelineExecProps = false;  // VK_KHR_pipeline_executable_properties
+
+    // VK_KHR_shader_clock with shaderSubgroupClock (enabled automatically
+    // when supported): GL_ARB_shader_clock's clock2x32ARB() in shaders
+    bool hasShaderClock = false;
+
+    BringUpTiming bringUp;
+
     void destroy();
 };
 
+/// How to bring a context up. The defaults give the minimal instance (no
+/// layers or extensions: compute needs none) and cache the selection.
+struct ContextOptions {
+    bool enablePipelineExecProps = false;
+
+    /// Remembers the chosen GPU and its capability queries; later runs on
+    /// the same device and driver skip them. Empty disables the cache.
+    std::string selectionCache = "vk_device_cache";
+
+    /// Extra instance layers/extensions (e.g. validation while debugging).
+    std::vector<const char*> instanceLayers;
+    std::vector<const char*> instanceExtensions;
+};
+
 /// Create a Vulkan compute context targeting the first NVIDIA discrete GPU.
-/// Enables VK_KHR_pipeline_executable_properties if available.
+/// Enables VK_KHR_pipeline_executable_properties if requested, and
+/// VK_EXT_external_memory_host, VK_KHR_shader_clock and the 8/16-bit
+/// storage and float16/int8 features whenever the device supports them.
+/// This overload does not use the selection cache.
 VkContext createComputeContext(bool enablePipelineExecProps = false);
 
+/// Create a context per `opts`; ctx.bringUp records where the time went.
+VkContext createComputeContext(const ContextOptions& opts);
+
+/// Start bring-up on a background thread, to overlap it with loading data.
+std::future<VkContext> createComputeContextAsync(ContextOptions opts = {});
+
+/// One context per process for every subsystem that asks: the first call
+/// creates it with `opts`, later calls return the same one (and throw if
+/// `opts` needs a feature it lacks). It is destroyed when the last
+/// reference drops, so hold one in main() to keep it alive between users.
+std::shared_ptr<const VkContext> sharedComputeContext(
+    const ContextOptions& opts = {});
+
+/// sharedComputeContext() on a background thread. Callers that ask for the
+/// shared context meanwhile block until this bring-up finishes.
+std::future<std::shared_ptr<const VkContext>> sharedComputeContextAsync(
+    ContextOptions opts = {});
+
 /// Find a memory type index matching the given filter and property flags.
 uint32_t findMemoryType(const VkContext& ctx, uint32_t typeFilter,
                         VkMemoryPropertyFlags properties);
 
-/// Create a device-local buffer with the given size and usage.
+/// Create a host-visible, coherent buffer with the given size and usage.
 VkBuffer createBuffer(const VkContext& ctx, VkDeviceSize size,
                       VkBufferUsageFlags usage, VkDeviceMemory& memory);
 
+/// Create a buffer in device-local memory. It cannot be mapped: fill it
+/// with a shader or a transfer (add VK_BUFFER_USAGE_TRANSFER_DST_BIT).
+VkBuffer createDeviceLocalBuffer(const VkContext& ctx, VkDeviceSize size,
+                                 VkBufferUsageFlags usage,
+                                 VkDeviceMemory& memory);
+
+/// Wrap an existing host allocation as a buffer without copying
+/// (VK_EXT_external_memory_host). `ptr` and `size` must be multiples of
+/// ctx.minImportedHostPointerAlignment, and the allocation must outlive the
+/// buffer and memory. Throws if the extension is unavailable.
+VkBuffer importHostBuffer(const VkContext& ctx, void* ptr, VkDeviceSize size,
+                          VkBufferUsageFlags usage, VkDeviceMemory& memory);
+
 /// Create a command pool for the compute queue family.
 VkCommandPool createCommandPool(const VkContext& ctx);
 
@@ -39,4 +123,16 @@ VkCommandBuffer allocateCommandBuffer(const VkContext& ctx, VkCommandPool pool);
 /// Submit a command buffer and wait for completion via fence.
 void submitAndWait(const VkContext& ctx, VkCommandBuffer cmd);
 
+/// Copy `size` bytes from `src` to `dst` on `cmd`, submit and wait: the
+/// staging upload / readback for device-local buffers. `src` needs
+/// TRANSFER_SRC usage and `dst` TRANSFER_DST. Barriers order the copy
+/// after earlier shader writes and before later shader or host access.
+void copyBuffer(const VkContext& ctx, VkCommandBuffer cmd, VkBuffer src,
+                VkBuffer dst, VkDeviceSize size);
+
+/// As above with explicit regions, all in one submission: a staging slab
+/// repeated across a large buffer, or scattered samples read back.
+void copyBuffer(const VkContext& ctx, VkCommandBuffer cmd, VkBuffer src,
+                VkBuffer dst, const std::vector<VkBufferCopy>& regions);
+
 }  // namespace vkutil
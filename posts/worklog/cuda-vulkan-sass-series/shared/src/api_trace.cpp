@@ -0,0 +1,184 @@
+#include "api_trace.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace apitrace {
+
+namespace {
+
+struct Event {
+    const char* name;
+    uint64_t start;
+    uint64_t end;
+};
+
+// One thread appends to its current chunk; readers take the registry lock
+// and read up to the published count.
+struct Chunk {
+    static constexpr size_t kCapacity = 16384;
+    Event events[kCapacity];
+    std::atomic<size_t> count{0};
+    uint32_t tid = 0;
+};
+
+std::mutex gRegistryMutex;
+std::vector<Chunk*> gChunks;
+std::atomic<uint32_t> gNextTid{1};
+std::atomic<uint64_t> gEpoch{0};  // bumped by reset() to retire TLS chunks
+
+thread_local Chunk* tlsChunk = nullptr;
+thread_local uint64_t tlsEpoch = 0;
+thread_local uint32_t tlsTid = 0;
+
+Chunk* newChunk() {
+    if (tlsTid == 0) tlsTid = gNextTid.fetch_add(1);
+    auto* c = new Chunk;
+    c->tid = tlsTid;
+    std::lock_guard<std::mutex> lock(gRegistryMutex);
+    gChunks.push_back(c);
+    return c;
+}
+
+// "vkCreateBuffer(ctx.device, ...)" → "vkCreateBuffer"
+std::string callName(const char* text) {
+    const char* paren = std::strchr(text, '(');
+    return paren ? std::string(text, paren) : std::string(text);
+}
+
+struct Stats {
+    uint64_t count = 0;
+    uint64_t totalNs = 0;
+    uint64_t maxNs = 0;
+};
+
+template <typename Fn>
+void forEachEvent(Fn&& fn) {
+    std::lock_guard<std::mutex> lock(gRegistryMutex);
+    for (Chunk* c : gChunks) {
+        size_t n = c->count.load(std::memory_order_acquire);
+        for (size_t i = 0; i < n; ++i) fn(*c, c->events[i]);
+    }
+}
+
+void jsonEscape(FILE* f, const std::string& s) {
+    for (char ch : s) {
+        if (ch == '"' || ch == '\\') fputc('\\', f);
+        fputc(ch, f);
+    }
+}
+
+void dumpAtExit() {
+    dumpSummary(stderr);
+    const char* path = std::getenv("SASS_API_TRACE_FILE");
+    std::string out = path ? path : "api_trace.json";
+    if (writeChromeTrace(out)) {
+        fprintf(stderr, "API trace written to %s\n", out.c_str());
+    }
+}
+
+bool initFromEnv() {
+#ifdef APITRACE_PRELOAD
+    // Built into the LD_PRELOAD interposer: being loaded is the opt-in.
+    bool on = true;
+#else
+    const char* v = std::getenv("SASS_API_TRACE");
+    bool on = v && *v && std::strcmp(v, "0") != 0;
+#endif
+    if (on) std::atexit(dumpAtExit);
+    return on;
+}
+
+}  // namespace
+
+std::atomic<bool> gEnabled{initFromEnv()};
+
+void setEnabled(bool on) { gEnabled.store(on, std::memory_order_relaxed); }
+
+uint64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+void record(const char* name, uint64_t startNs, uint64_t endNs) {
+    uint64_t epoch = gEpoch.load(std::memory_order_relaxed);
+    Chunk* c = tlsChunk;
+    if (!c || tlsEpoch != epoch ||
+        c->count.load(std::memory_order_relaxed) == Chunk::kCapacity) {
+        c = tlsChunk = newChunk();
+        tlsEpoch = epoch;
+    }
+    size_t i = c->count.load(std::memory_order_relaxed);
+    c->events[i] = {name, startNs, endNs};
+    c->count.store(i + 1, std::memory_order_release);
+}
+
+void dumpSummary(FILE* out) {
+    std::map<std::string, Stats> byName;
+    uint64_t totalNs = 0;
+    forEachEvent([&](const Chunk&, const Event& e) {
+        Stats& s = byName[callName(e.name)];
+        uint64_t d = e.end - e.start;
+        ++s.count;
+        s.totalNs += d;
+        s.maxNs = std::max(s.maxNs, d);
+        totalNs += d;
+    });
+
+    std::vector<std::pair<std::string, Stats>> rows(byName.begin(),
+                                                    byName.end());
+    std::sort(rows.begin(), rows.end(), [](const auto& a, const auto& b) {
+        return a.second.totalNs > b.second.totalNs;
+    });
+
+    fprintf(out, "\n--- API trace summary (%.3f ms in traced calls) ---\n",
+            totalNs / 1e6);
+    fprintf(out, "  %10s %12s %6s %12s %12s  %s\n", "calls", "total ms", "%",
+            "mean us", "max us", "call");
+    for (auto& [name, s] : rows) {
+        fprintf(out, "  %10llu %12.3f %5.1f%% %12.3f %12.3f  %s\n",
+                static_cast<unsigned long long>(s.count), s.totalNs / 1e6,
+                totalNs ? 100.0 * s.totalNs / totalNs : 0.0,
+                s.totalNs / 1e3 / s.count, s.maxNs / 1e3, name.c_str());
+    }
+}
+
+bool writeChromeTrace(const std::string& path) {
+    FILE* f = fopen(path.c_str(), "w");
+    if (!f) return false;
+
+    uint64_t t0 = UINT64_MAX;
+    forEachEvent([&](const Chunk&, const Event& e) {
+        t0 = std::min(t0, e.start);
+    });
+
+    fprintf(f, "{\"traceEvents\":[\n");
+    bool first = true;
+    forEachEvent([&](const Chunk& c, const Event& e) {
+        fprintf(f, "%s{\"name\":\"", first ? "" : ",\n");
+        jsonEscape(f, callName(e.name));
+        fprintf(f, "\",\"cat\":\"api\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,"
+                   "\"pid\":1,\"tid\":%u,\"args\":{\"call\":\"",
+                (e.start - t0) / 1e3, (e.end - e.start) / 1e3, c.tid);
+        jsonEscape(f, e.name);
+        fprintf(f, "\"}}");
+        first = false;
+    });
+    fprintf(f, "\n]}\n");
+    fclose(f);
+    return true;
+}
+
+void reset() {
+    std::lock_guard<std::mutex> lock(gRegistryMutex);
+    for (Chunk* c : gChunks) delete c;
+    gChunks.clear();
+    gEpoch.fetch_add(1);
+}
+
+}  // namespace apitrace
@@ -0,0 +1,275 @@
+// api_trace_preload.cpp — LD_PRELOAD interposer for the tracer.
+// Defines the exported vk* (libvulkan) and cu* (libcuda) entry points the
+// series uses, records each call through apitrace and forwards it to the
+// next definition (dlsym RTLD_NEXT). Loading it traces an unmodified
+// binary, including the calls experiments make outside shared_lib:
+//
+//   LD_PRELOAD=./libapi_trace_preload.so ./exp13_grid_stride
+//
+// Not seen: pointers fetched with vkGet*ProcAddr / cuGetProcAddress, which
+// is how the statically linked CUDA runtime (cudaMalloc, <<<>>>) reaches
+// the driver. Use this or SASS_API_TRACE=1, not both: with both, a helper
+// call is recorded once by each tracer.
+#include "api_trace.h"
+#include <cuda.h>
+#include <vulkan/vulkan.h>
+#include <dlfcn.h>
+#include <cstdio>
+#include <cstdlib>
+
+namespace {
+
+void* nextSymbol(const char* name) {
+    void* fn = dlsym(RTLD_NEXT, name);
+    if (!fn) {
+        fprintf(stderr, "api_trace_preload: %s not found\n", name);
+        std::abort();
+    }
+    return fn;
+}
+
+}  // namespace
+
+#define TRACE_STR2(x) #x
+#define TRACE_STR(x) TRACE_STR2(x)
+
+// One interposed entry point. `name` may be a cuda.h macro (cuMemAlloc →
+// cuMemAlloc_v2); TRACE_STR expands it so the versioned symbol is
+// looked up and recorded.
+#define TRACE_HOOK(ret, name, params, args)                                \
+    extern "C" __attribute__((visibility("default"))) ret name params {    \
+        static auto real =                                                 \
+            reinterpret_cast<ret(*) params>(nextSymbol(TRACE_STR(name)));  \
+        return ::apitrace::traced(TRACE_STR(name), [&] { return real args; }); \
+    }
+
+// ---------- Vulkan: instance and physical device ----------
+
+TRACE_HOOK(VkResult, vkCreateInstance,
+           (const VkInstanceCreateInfo* ci, const VkAllocationCallbacks* a,
+            VkInstance* out),
+           (ci, a, out))
+TRACE_HOOK(void, vkDestroyInstance,
+           (VkInstance i, const VkAllocationCallbacks* a), (i, a))
+TRACE_HOOK(VkResult, vkEnumeratePhysicalDevices,
+           (VkInstance i, uint32_t* n, VkPhysicalDevice* out), (i, n, out))
+TRACE_HOOK(void, vkGetPhysicalDeviceProperties,
+           (VkPhysicalDevice p, VkPhysicalDeviceProperties* out), (p, out))
+TRACE_HOOK(void, vkGetPhysicalDeviceProperties2,
+           (VkPhysicalDevice p, VkPhysicalDeviceProperties2* out), (p, out))
+TRACE_HOOK(void, vkGetPhysicalDeviceFeatures2,
+           (VkPhysicalDevice p, VkPhysicalDeviceFeatures2* out), (p, out))
+TRACE_HOOK(void, vkGetPhysicalDeviceMemoryProperties,
+           (VkPhysicalDevice p, VkPhysicalDeviceMemoryProperties* out),
+           (p, out))
+TRACE_HOOK(void, vkGetPhysicalDeviceQueueFamilyProperties,
+           (VkPhysicalDevice p, uint32_t* n, VkQueueFamilyProperties* out),
+           (p, n, out))
+TRACE_HOOK(VkResult, vkEnumerateDeviceExtensionProperties,
+           (VkPhysicalDevice p, const char* layer, uint32_t* n,
+            VkExtensionProperties* out),
+           (p, layer, n, out))
+
+// ---------- Vulkan: device, memory, buffers ----------
+
+TRACE_HOOK(VkResult, vkCreateDevice,
+           (VkPhysicalDevice p, const VkDeviceCreateInfo* ci,
+            const VkAllocationCallbacks* a, VkDevice* out),
+           (p, ci, a, out))
+TRACE_HOOK(void, vkDestroyDevice,
+           (VkDevice d, const VkAllocationCallbacks* a), (d, a))
+TRACE_HOOK(void, vkGetDeviceQueue,
+           (VkDevice d, uint32_t family, uint32_t index, VkQueue* out),
+           (d, family, index, out))
+TRACE_HOOK(VkResult, vkDeviceWaitIdle, (VkDevice d), (d))
+TRACE_HOOK(VkResult, vkCreateBuffer,
+           (VkDevice d, const VkBufferCreateInfo* ci,
+            const VkAllocationCallbacks* a, VkBuffer* out),
+           (d, ci, a, out))
+TRACE_HOOK(void, vkDestroyBuffer,
+           (VkDevice d, VkBuffer b, const VkAllocationCallbacks* a), (d, b, a))
+TRACE_HOOK(void, vkGetBufferMemoryRequirements,
+           (VkDevice d, VkBuffer b, VkMemoryRequirements* out), (d, b, out))
+TRACE_HOOK(VkResult, vkAllocateMemory,
+           (VkDevice d, const VkMemoryAllocateInfo* ai,
+            const VkAllocationCallbacks* a, VkDeviceMemory* out),
+           (d, ai, a, out))
+TRACE_HOOK(void, vkFreeMemory,
+           (VkDevice d, VkDeviceMemory m, const VkAllocationCallbacks* a),
+           (d, m, a))
+TRACE_HOOK(VkResult, vkBindBufferMemory,
+           (VkDevice d, VkBuffer b, VkDeviceMemory m, VkDeviceSize offset),
+           (d, b, m, offset))
+TRACE_HOOK(VkResult, vkMapMemory,
+           (VkDevice d, VkDeviceMemory m, VkDeviceSize offset,
+            VkDeviceSize size, VkMemoryMapFlags flags, void** out),
+           (d, m, offset, size, flags, out))
+TRACE_HOOK(void, vkUnmapMemory, (VkDevice d, VkDeviceMemory m), (d, m))
+
+// ---------- Vulkan: pipelines and descriptors ----------
+
+TRACE_HOOK(VkResult, vkCreateShaderModule,
+           (VkDevice d, const VkShaderModuleCreateInfo* ci,
+            const VkAllocationCallbacks* a, VkShaderModule* out),
+           (d, ci, a, out))
+TRACE_HOOK(void, vkDestroyShaderModule,
+           (VkDevice d, VkShaderModule s, const VkAllocationCallbacks* a),
+           (d, s, a))
+TRACE_HOOK(VkResult, vkCreatePipelineCache,
+           (VkDevice d, const VkPipelineCacheCreateInfo* ci,
+            const VkAllocationCallbacks* a, VkPipelineCache* out),
+           (d, ci, a, out))
+TRACE_HOOK(VkResult, vkGetPipelineCacheData,
+           (VkDevice d, VkPipelineCache c, size_t* size, void* data),
+           (d, c, size, data))
+TRACE_HOOK(void, vkDestroyPipelineCache,
+           (VkDevice d, VkPipelineCache c, const VkAllocationCallbacks* a),
+           (d, c, a))
+TRACE_HOOK(VkResult, vkCreateComputePipelines,
+           (VkDevice d, VkPipelineCache c, uint32_t n,
+            const VkComputePipelineCreateInfo* ci,
+            const VkAllocationCallbacks* a, VkPipeline* out),
+           (d, c, n, ci, a, out))
+TRACE_HOOK(void, vkDestroyPipeline,
+           (VkDevice d, VkPipeline p, const VkAllocationCallbacks* a),
+           (d, p, a))
+TRACE_HOOK(VkResult, vkCreatePipelineLayout,
+           (VkDevice d, const VkPipelineLayoutCreateInfo* ci,
+            const VkAllocationCallbacks* a, VkPipelineLayout* out),
+           (d, ci, a, out))
+TRACE_HOOK(void, vkDestroyPipelineLayout,
+           (VkDevice d, VkPipelineLayout l, const VkAllocationCallbacks* a),
+           (d, l, a))
+TRACE_HOOK(VkResult, vkCreateDescriptorSetLayout,
+           (VkDevice d, const VkDescriptorSetLayoutCreateInfo* ci,
+            const VkAllocationCallbacks* a, VkDescriptorSetLayout* out),
+           (d, ci, a, out))
+TRACE_HOOK(void, vkDestroyDescriptorSetLayout,
+           (VkDevice d, VkDescriptorSetLayout l,
+            const VkAllocationCallbacks* a),
+           (d, l, a))
+TRACE_HOOK(VkResult, vkCreateDescriptorPool,
+           (VkDevice d, const VkDescriptorPoolCreateInfo* ci,
+            const VkAllocationCallbacks* a, VkDescriptorPool* out),
+           (d, ci, a, out))
+TRACE_HOOK(void, vkDestroyDescriptorPool,
+           (VkDevice d, VkDescriptorPool p, const VkAllocationCallbacks* a),
+           (d, p, a))
+TRACE_HOOK(VkResult, vkResetDescriptorPool,
+           (VkDevice d, VkDescriptorPool p, VkDescriptorPoolResetFlags f),
+           (d, p, f))
+TRACE_HOOK(VkResult, vkAllocateDescriptorSets,
+           (VkDevice d, const VkDescriptorSetAllocateInfo* ai,
+            VkDescriptorSet* out),
+           (d, ai, out))
+TRACE_HOOK(void, vkUpdateDescriptorSets,
+           (VkDevice d, uint32_t nWrites, const VkWriteDescriptorSet* writes,
+            uint32_t nCopies, const VkCopyDescriptorSet* copies),
+           (d, nWrites, writes, nCopies, copies))
+
+// ---------- Vulkan: commands and submission ----------
+
+TRACE_HOOK(VkResult, vkCreateCommandPool,
+           (VkDevice d, const VkCommandPoolCreateInfo* ci,
+            const VkAllocationCallbacks* a, VkCommandPool* out),
+           (d, ci, a, out))
+TRACE_HOOK(void, vkDestroyCommandPool,
+           (VkDevice d, VkCommandPool p, const VkAllocationCallbacks* a),
+           (d, p, a))
+TRACE_HOOK(VkResult, vkAllocateCommandBuffers,
+           (VkDevice d, const VkCommandBufferAllocateInfo* ai,
+            VkCommandBuffer* out),
+           (d, ai, out))
+TRACE_HOOK(VkResult, vkBeginCommandBuffer,
+           (VkCommandBuffer c, const VkCommandBufferBeginInfo* bi), (c, bi))
+TRACE_HOOK(VkResult, vkEndCommandBuffer, (VkCommandBuffer c), (c))
+TRACE_HOOK(void, vkCmdBindPipeline,
+           (VkCommandBuffer c, VkPipelineBindPoint bp, VkPipeline p),
+           (c, bp, p))
+TRACE_HOOK(void, vkCmdBindDescriptorSets,
+           (VkCommandBuffer c, VkPipelineBindPoint bp, VkPipelineLayout l,
+            uint32_t first, uint32_t n, const VkDescriptorSet* sets,
+            uint32_t nDynamic, const uint32_t* offsets),
+           (c, bp, l, first, n, sets, nDynamic, offsets))
+TRACE_HOOK(void, vkCmdPushConstants,
+           (VkCommandBuffer c, VkPipelineLayout l, VkShaderStageFlags stages,
+            uint32_t offset, uint32_t size, const void* data),
+           (c, l, stages, offset, size, data))
+TRACE_HOOK(void, vkCmdDispatch,
+           (VkCommandBuffer c, uint32_t x, uint32_t y, uint32_t z),
+           (c, x, y, z))
+TRACE_HOOK(void, vkCmdDispatchIndirect,
+           (VkCommandBuffer c, VkBuffer b, VkDeviceSize offset), (c, b, offset))
+TRACE_HOOK(void, vkCmdCopyBuffer,
+           (VkCommandBuffer c, VkBuffer src, VkBuffer dst, uint32_t n,
+            const VkBufferCopy* regions),
+           (c, src, dst, n, regions))
+TRACE_HOOK(void, vkCmdFillBuffer,
+           (VkCommandBuffer c, VkBuffer b, VkDeviceSize offset,
+            VkDeviceSize size, uint32_t value),
+           (c, b, offset, size, value))
+TRACE_HOOK(void, vkCmdPipelineBarrier,
+           (VkCommandBuffer c, VkPipelineStageFlags src,
+            VkPipelineStageFlags dst, VkDependencyFlags flags, uint32_t nMem,
+            const VkMemoryBarrier* mem, uint32_t nBuf,
+            const VkBufferMemoryBarrier* buf, uint32_t nImg,
+            const VkImageMemoryBarrier* img),
+           (c, src, dst, flags, nMem, mem, nBuf, buf, nImg, img))
+TRACE_HOOK(VkResult, vkCreateFence,
+           (VkDevice d, const VkFenceCreateInfo* ci,
+            const VkAllocationCallbacks* a, VkFence* out),
+           (d, ci, a, out))
+TRACE_HOOK(void, vkDestroyFence,
+           (VkDevice d, VkFence f, const VkAllocationCallbacks* a), (d, f, a))
+TRACE_HOOK(VkResult, vkQueueSubmit,
+           (VkQueue q, uint32_t n, const VkSubmitInfo* submits, VkFence f),
+           (q, n, submits, f))
+TRACE_HOOK(VkResult, vkWaitForFences,
+           (VkDevice d, uint32_t n, const VkFence* fences, VkBool32 all,
+            uint64_t timeout),
+           (d, n, fences, all, timeout))
+
+// ---------- CUDA driver ----------
+
+TRACE_HOOK(CUresult, cuInit, (unsigned int flags), (flags))
+TRACE_HOOK(CUresult, cuDeviceGet, (CUdevice* out, int ordinal),
+           (out, ordinal))
+TRACE_HOOK(CUresult, cuDeviceGetName, (char* name, int len, CUdevice dev),
+           (name, len, dev))
+TRACE_HOOK(CUresult, cuDeviceGetAttribute,
+           (int* out, CUdevice_attribute attr, CUdevice dev), (out, attr, dev))
+TRACE_HOOK(CUresult, cuCtxCreate,
+           (CUcontext* out, unsigned int flags, CUdevice dev),
+           (out, flags, dev))
+TRACE_HOOK(CUresult, cuCtxDestroy, (CUcontext ctx), (ctx))
+TRACE_HOOK(CUresult, cuCtxGetDevice, (CUdevice* out), (out))
+TRACE_HOOK(CUresult, cuCtxSynchronize, (), ())
+TRACE_HOOK(CUresult, cuModuleLoad, (CUmodule* out, const char* path),
+           (out, path))
+TRACE_HOOK(CUresult, cuModuleLoadData, (CUmodule* out, const void* image),
+           (out, image))
+TRACE_HOOK(CUresult, cuModuleUnload, (CUmodule m), (m))
+TRACE_HOOK(CUresult, cuModuleGetFunction,
+           (CUfunction* out, CUmodule m, const char* name), (out, m, name))
+TRACE_HOOK(CUresult, cuLaunchKernel,
+           (CUfunction f, unsigned int gx, unsigned int gy, unsigned int gz,
+            unsigned int bx, unsigned int by, unsigned int bz,
+            unsigned int shared, CUstream s, void** params, void** extra),
+           (f, gx, gy, gz, bx, by, bz, shared, s, params, extra))
+TRACE_HOOK(CUresult, cuMemAlloc, (CUdeviceptr* out, size_t bytes),
+           (out, bytes))
+TRACE_HOOK(CUresult, cuMemFree, (CUdeviceptr p), (p))
+TRACE_HOOK(CUresult, cuMemGetInfo, (size_t* free, size_t* total),
+           (free, total))
+TRACE_HOOK(CUresult, cuMemcpyHtoD,
+           (CUdeviceptr dst, const void* src, size_t bytes), (dst, src, bytes))
+TRACE_HOOK(CUresult, cuMemcpyDtoH,
+           (void* dst, CUdeviceptr src, size_t bytes), (dst, src, bytes))
+TRACE_HOOK(CUresult, cuMemsetD32,
+           (CUdeviceptr dst, unsigned int value, size_t count),
+           (dst, value, count))
+TRACE_HOOK(CUresult, cuMemHostRegister,
+           (void* p, size_t bytes, unsigned int flags), (p, bytes, flags))
+TRACE_HOOK(CUresult, cuMemHostUnregister, (void* p), (p))
+TRACE_HOOK(CUresult, cuMemHostGetDevicePointer,
+           (CUdeviceptr* out, void* p, unsigned int flags), (out, p, flags))
@@ -1,11 +1,13 @@
 #include "cuda_context.h"
+#include "api_trace.h"
+#include <algorithm>
 #include <cstdio>
 #include <cstdlib>
 #include <stdexcept>
 
 #define CU_CHECK(call)                                                     \
     do {                                                                   \
-        CUresult r = (call);                                               \
+        CUresult r = API_TRACE(call);                                      \
         if (r != CUDA_SUCCESS) {                                           \
             const char* errStr = nullptr;                                  \
             cuGetErrorString(r, &errStr);                                  \
@@ -19,7 +21,7 @@ namespace cuutil {
 
 void CudaContext::destroy() {
     if (context) {
-        cuCtxDestroy(context);
+        API_TRACE(cuCtxDestroy(context));
         context = nullptr;
     }
 }
@@ -30,7 +32,7 @@ CudaContext createContext(int deviceOrdinal) {
     CU_CHECK(cuDeviceGet(&ctx.device, deviceOrdinal));
 
     char name[256];
-    cuDeviceGetName(name, sizeof(name), ctx.device);
+    API_TRACE(cuDeviceGetName(name, sizeof(name), ctx.device));
     printf("CUDA device: %s\n", name);
 
     CU_CHECK(cuCtxCreate(&ctx.context, 0, ctx.device));
@@ -56,7 +58,7 @@ CUdeviceptr allocDevice(size_t bytes) {
 }
 
 void freeDevice(CUdeviceptr ptr) {
-    cuMemFree(ptr);
+    API_TRACE(cuMemFree(ptr));
 }
 
 void copyToDevice(CUdeviceptr dst, const void* src, size_t bytes) {
@@ -67,4 +69,30 @@ void copyToHost(void* dst, CUdeviceptr src, size_t bytes) {
     CU_CHECK(cuMemcpyDtoH(dst, src, bytes));
 }
 
+CUdeviceptr registerHost(void* ptr, size_t bytes) {
+    CU_CHECK(cuMemHostRegister(ptr, bytes, CU_MEMHOSTREGISTER_DEVICEMAP));
+    CUdeviceptr dptr;
+    CU_CHECK(cuMemHostGetDevicePointer(&dptr, ptr, 0));
+    return dptr;
+}
+
+void unregisterHost(void* ptr) {
+    API_TRACE(cuMemHostUnregister(ptr));
+}
+
+unsigned gridStrideBlocks(size_t n, unsigned blockSize) {
+    CUdevice dev;
+    CU_CHECK(cuCtxGetDevice(&dev));
+    int sms = 0, threadsPerSm = 0;
+    CU_CHECK(cuDeviceGetAttribute(
+        &sms, CU_DEVICE_ATTRIBUTE_MULTIPROCESSOR_COUNT, dev));
+    CU_CHECK(cuDeviceGetAttribute(
+        &threadsPerSm, CU_DEVICE_ATTRIBUTE_MAX_THREADS_PER_MULTIPROCESSOR,
+        dev));
+
+    size_t wave = size_t(sms) * threadsPerSm / blockSize;
+    size_t blocks = n / blockSize + (n % blockSize != 0);
+    return static_cast<unsigned>(std::max<size_t>(1, std::min(blocks, wave)));
+}
+
 }  // namespace cuutil
@@ -0,0 +1,314 @@
+#include "fuse.h"
+#include "api_trace.h"
+#include <nvrtc.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+#define VK_CHECK(call)                                                   \
+    do {                                                                 \
+        VkResult r = API_TRACE(call);                                    \
+        if (r != VK_SUCCESS) {                                           \
+            fprintf(stderr, "Vulkan error %d at %s:%d\n", r, __FILE__,  \
+                    __LINE__);                                           \
+            std::abort();                                                \
+        }                                                                \
+    } while (0)
+
+#define CU_CHECK(call)                                                     \
+    do {                                                                   \
+        CUresult r = API_TRACE(call);                                      \
+        if (r != CUDA_SUCCESS) {                                           \
+            const char* errStr = nullptr;                                  \
+            cuGetErrorString(r, &errStr);                                  \
+            fprintf(stderr, "CUDA Driver error %d (%s) at %s:%d\n", r,    \
+                    errStr ? errStr : "unknown", __FILE__, __LINE__);      \
+            std::abort();                                                  \
+        }                                                                  \
+    } while (0)
+
+namespace fuse {
+
+namespace {
+
+using Clock = std::chrono::high_resolution_clock;
+
+// Output + inputs per kernel. Vulkan only guarantees 4 storage buffers per
+// stage; the device limit is checked as well.
+constexpr uint32_t kMaxArrays = 16;
+
+// { uint N; float s0..; } must fit the guaranteed 128-byte push range.
+constexpr size_t kMaxScalars = 31;
+
+void checkShape(const Fused& f) {
+    if (f.slots.size() + 1 > kMaxArrays) {
+        throw std::runtime_error("fuse: expression reads too many arrays: " +
+                                 f.expr);
+    }
+    if (f.scalars.size() > kMaxScalars) {
+        throw std::runtime_error("fuse: expression has too many scalars: " +
+                                 f.expr);
+    }
+}
+
+std::string hexHash(uint64_t h) {
+    char buf[17];
+    snprintf(buf, sizeof(buf), "%016llx", static_cast<unsigned long long>(h));
+    return buf;
+}
+
+double msSince(Clock::time_point t0) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - t0)
+        .count();
+}
+
+}  // namespace
+
+// ---------- Code generation ----------
+
+std::string emitGlsl(const Fused& f) {
+    checkShape(f);
+    std::string s;
+    s += "// fused: " + f.expr + "\n";
+    s += "#version 450\n\n";
+    s += "layout(local_size_x = 256) in;\n\n";
+    s += "layout(std430, binding = 0) writeonly buffer Out "
+         "{ float out_[]; };\n";
+    for (size_t k = 0; k < f.slots.size(); ++k) {
+        std::string n = std::to_string(k);
+        s += "layout(std430, binding = " + std::to_string(k + 1) +
+             ") readonly buffer In" + n + " { float in" + n + "[]; };\n";
+    }
+    s += "\nlayout(push_constant) uniform PushConstants {\n    uint N;\n";
+    for (size_t k = 0; k < f.scalars.size(); ++k) {
+        s += "    float s" + std::to_string(k) + ";\n";
+    }
+    s += "};\n\n";
+    s += "void main() {\n";
+    s += "    uint stride = gl_NumWorkGroups.x * gl_WorkGroupSize.x;\n";
+    s += "    for (uint i = gl_GlobalInvocationID.x; i < N; i += stride) {\n";
+    for (size_t k = 0; k < f.slots.size(); ++k) {
+        std::string n = std::to_string(k);
+        s += "        float x" + n + " = in" + n + "[i];\n";
+    }
+    s += "        out_[i] = " + f.expr + ";\n";
+    s += "    }\n";
+    s += "}\n";
+    return s;
+}
+
+std::string emitCuda(const Fused& f) {
+    checkShape(f);
+    std::string s;
+    s += "// fused: " + f.expr + "\n";
+    s += "extern \"C\" __global__ void fused(float* out";
+    for (size_t k = 0; k < f.slots.size(); ++k) {
+        s += ", const float* in" + std::to_string(k);
+    }
+    for (size_t k = 0; k < f.scalars.size(); ++k) {
+        s += ", float s" + std::to_string(k);
+    }
+    s += ", size_t N) {\n";
+    s += "    size_t stride = size_t(gridDim.x) * blockDim.x;\n";
+    s += "    for (size_t i = size_t(blockIdx.x) * blockDim.x + threadIdx.x;"
+         " i < N;\n";
+    s += "         i += stride) {\n";
+    for (size_t k = 0; k < f.slots.size(); ++k) {
+        std::string n = std::to_string(k);
+        s += "        float x" + n + " = in" + n + "[i];\n";
+    }
+    s += "        out[i] = " + f.expr + ";\n";
+    s += "    }\n";
+    s += "}\n";
+    return s;
+}
+
+// ---------- Vulkan backend ----------
+
+VkFuser::VkFuser(const vkutil::VkContext& ctx,
+                 vkutil::ShaderCompiler& compiler, uint32_t maxBindings)
+    : ctx_(ctx), compiler_(compiler) {
+    VkDescriptorPoolSize poolSize{VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                                  maxBindings * kMaxArrays};
+    VkDescriptorPoolCreateInfo poolCI{
+        VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO};
+    poolCI.maxSets = maxBindings;
+    poolCI.poolSizeCount = 1;
+    poolCI.pPoolSizes = &poolSize;
+    VK_CHECK(vkCreateDescriptorPool(ctx_.device, &poolCI, nullptr, &pool_));
+}
+
+VkFuser::~VkFuser() {
+    for (auto& [expr, k] : kernels_) k.destroy(ctx_.device);
+    API_TRACE(vkDestroyDescriptorPool(ctx_.device, pool_, nullptr));
+}
+
+const vkutil::ComputeKernel& VkFuser::kernel(const Fused& f) {
+    // Keyed on the text, not f.hash: a hash collision must not hand back
+    // another expression's pipeline.
+    auto it = kernels_.find(f.expr);
+    if (it != kernels_.end()) return it->second;
+
+    checkShape(f);
+    VkPhysicalDeviceProperties props;
+    API_TRACE(vkGetPhysicalDeviceProperties(ctx_.physicalDevice, &props));
+    uint32_t arrays = static_cast<uint32_t>(f.slots.size() + 1);
+    if (arrays > props.limits.maxPerStageDescriptorStorageBuffers) {
+        throw std::runtime_error(
+            "fuse: device allows " +
+            std::to_string(props.limits.maxPerStageDescriptorStorageBuffers) +
+            " storage buffers per stage, expression needs " +
+            std::to_string(arrays) + ": " + f.expr);
+    }
+
+    auto t0 = Clock::now();
+    auto spirv = compiler_.compileSource(
+        emitGlsl(f), "fused_" + hexHash(f.hash) + ".comp");
+    auto k = vkutil::createComputeKernel(
+        ctx_, spirv, arrays,
+        static_cast<uint32_t>(sizeof(int) + f.scalars.size() * sizeof(float)));
+    compileMs_ += msSince(t0);
+    return kernels_.emplace(f.expr, k).first->second;
+}
+
+VkDescriptorSet VkFuser::bind(const Fused& f, VkBuffer out,
+                              const std::vector<VkBuffer>& arrays) {
+    const auto& k = kernel(f);
+
+    VkDescriptorSetAllocateInfo allocInfo{
+        VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO};
+    allocInfo.descriptorPool = pool_;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &k.setLayout;
+    VkDescriptorSet set;
+    VK_CHECK(vkAllocateDescriptorSets(ctx_.device, &allocInfo, &set));
+
+    std::vector<VkDescriptorBufferInfo> infos;
+    infos.push_back({out, 0, VK_WHOLE_SIZE});
+    for (int slot : f.slots) {
+        if (slot < 0 || size_t(slot) >= arrays.size()) {
+            throw std::runtime_error("fuse: no array bound for slot " +
+                                     std::to_string(slot));
+        }
+        infos.push_back({arrays[slot], 0, VK_WHOLE_SIZE});
+    }
+
+    std::vector<VkWriteDescriptorSet> writes(infos.size());
+    for (size_t i = 0; i < infos.size(); ++i) {
+        writes[i] = {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
+        writes[i].dstSet = set;
+        writes[i].dstBinding = static_cast<uint32_t>(i);
+        writes[i].descriptorCount = 1;
+        writes[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        writes[i].pBufferInfo = &infos[i];
+    }
+    API_TRACE(vkUpdateDescriptorSets(ctx_.device,
+                                     static_cast<uint32_t>(writes.size()),
+                                     writes.data(), 0, nullptr));
+    return set;
+}
+
+void VkFuser::record(VkCommandBuffer cmd, const Fused& f, VkDescriptorSet set,
+                     uint32_t N) {
+    // Same pipeline and layout, but dispatched with the caller's set.
+    vkutil::ComputeKernel k = kernel(f);
+    k.descriptorSet = set;
+
+    std::vector<float> push(1 + f.scalars.size());
+    static_assert(sizeof(N) == sizeof(float), "push block layout");
+    memcpy(push.data(), &N, sizeof(N));
+    std::copy(f.scalars.begin(), f.scalars.end(), push.begin() + 1);
+
+    vkutil::recordDispatch(cmd, k, push.data(), vkutil::gridStrideGroups(N));
+}
+
+void VkFuser::resetBindings() {
+    VK_CHECK(vkResetDescriptorPool(ctx_.device, pool_, 0));
+}
+
+// ---------- CUDA backend ----------
+
+CuFuser::CuFuser() {
+    CUdevice dev;
+    CU_CHECK(cuCtxGetDevice(&dev));
+    int major = 0, minor = 0;
+    CU_CHECK(cuDeviceGetAttribute(
+        &major, CU_DEVICE_ATTRIBUTE_COMPUTE_CAPABILITY_MAJOR, dev));
+    CU_CHECK(cuDeviceGetAttribute(
+        &minor, CU_DEVICE_ATTRIBUTE_COMPUTE_CAPABILITY_MINOR, dev));
+    arch_ = "--gpu-architecture=compute_" + std::to_string(major * 10 + minor);
+}
+
+CuFuser::~CuFuser() {
+    for (auto& [expr, e] : kernels_) API_TRACE(cuModuleUnload(e.module));
+}
+
+CUfunction CuFuser::function(const Fused& f) {
+    auto it = kernels_.find(f.expr);  // see VkFuser::kernel
+    if (it != kernels_.end()) return it->second.function;
+
+    auto t0 = Clock::now();
+    std::string src = emitCuda(f);
+    std::string name = "fused_" + hexHash(f.hash) + ".cu";
+
+    nvrtcProgram prog;
+    if (nvrtcCreateProgram(&prog, src.c_str(), name.c_str(), 0, nullptr,
+                           nullptr) != NVRTC_SUCCESS) {
+        throw std::runtime_error("fuse: nvrtcCreateProgram failed");
+    }
+    const char* opts[] = {arch_.c_str(), "--std=c++17"};
+    nvrtcResult res = nvrtcCompileProgram(prog, 2, opts);
+
+    size_t logSize = 0;
+    nvrtcGetProgramLogSize(prog, &logSize);
+    std::string log(logSize, '\0');
+    if (logSize > 1) nvrtcGetProgramLog(prog, &log[0]);
+    if (res != NVRTC_SUCCESS) {
+        nvrtcDestroyProgram(&prog);
+        throw std::runtime_error(name + ": " + log + "\n" + src);
+    }
+
+    size_t ptxSize = 0;
+    nvrtcGetPTXSize(prog, &ptxSize);
+    std::string ptx(ptxSize, '\0');
+    nvrtcGetPTX(prog, &ptx[0]);
+    nvrtcDestroyProgram(&prog);
+
+    Entry e;
+    CU_CHECK(cuModuleLoadData(&e.module, ptx.c_str()));
+    CU_CHECK(cuModuleGetFunction(&e.function, e.module, "fused"));
+    compileMs_ += msSince(t0);
+    return kernels_.emplace(f.expr, e).first->second.function;
+}
+
+void CuFuser::launch(const Fused& f, CUdeviceptr out,
+                     const std::vector<CUdeviceptr>& arrays, size_t N,
+                     CUstream stream) {
+    CUfunction fn = function(f);
+
+    // cuLaunchKernel takes one pointer per parameter, in declaration order.
+    std::vector<CUdeviceptr> ins;
+    for (int slot : f.slots) {
+        if (slot < 0 || size_t(slot) >= arrays.size()) {
+            throw std::runtime_error("fuse: no array bound for slot " +
+                                     std::to_string(slot));
+        }
+        ins.push_back(arrays[slot]);
+    }
+    std::vector<float> scalars = f.scalars;
+
+    std::vector<void*> args;
+    args.push_back(&out);
+    for (auto& p : ins) args.push_back(&p);
+    for (auto& s : scalars) args.push_back(&s);
+    args.push_back(&N);
+
+    unsigned grid = cuutil::gridStrideBlocks(N);
+    CU_CHECK(cuLaunchKernel(fn, grid, 1, 1, 256, 1, 1, 0, stream, args.data(),
+                            nullptr));
+}
+
+}  // namespace fuse
@@ -0,0 +1,60 @@
+#include "host_memory.h"
+#include <cstdlib>
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace hostutil {
+
+void HostBuffer::release() {
+    if (!data) return;
+    if (fileBacked) {
+        munmap(data, bytes);
+    } else {
+        std::free(data);
+    }
+    data = nullptr;
+    bytes = 0;
+}
+
+size_t pageSize() {
+    static const size_t size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    return size;
+}
+
+HostBuffer allocAligned(size_t bytes, size_t alignment) {
+    if (alignment < pageSize()) alignment = pageSize();
+    HostBuffer buf;
+    buf.bytes = roundUp(bytes, alignment);
+    buf.data = std::aligned_alloc(alignment, buf.bytes);
+    if (!buf.data) {
+        throw std::runtime_error("aligned_alloc failed");
+    }
+    return buf;
+}
+
+HostBuffer mapFile(const std::string& path, size_t bytes) {
+    HostBuffer buf;
+    buf.bytes = roundUp(bytes, pageSize());
+    buf.fileBacked = true;
+
+    int fd = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open " + path);
+    }
+    if (ftruncate(fd, static_cast<off_t>(buf.bytes)) != 0) {
+        close(fd);
+        throw std::runtime_error("Cannot resize " + path);
+    }
+    buf.data = mmap(nullptr, buf.bytes, PROT_READ | PROT_WRITE, MAP_SHARED,
+                    fd, 0);
+    close(fd);  // the mapping keeps the file alive
+    if (buf.data == MAP_FAILED) {
+        buf.data = nullptr;
+        throw std::runtime_error("mmap failed for " + path);
+    }
+    return buf;
+}
+
+}  // namespace hostutil
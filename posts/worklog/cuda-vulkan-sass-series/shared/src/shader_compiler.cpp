@@ -0,0 +1,296 @@
+#include "shader_compiler.h"
+#include <shaderc/shaderc.hpp>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+
+#if defined(__linux__)
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace vkutil {
+
+namespace {
+
+// Bumped whenever the compile options below change, so stale cache entries
+// from an older configuration are never reused.
+constexpr const char* kCacheTag = "glsl-comp/vulkan1.2/v1";
+
+bool readText(const std::string& path, std::string& out) {
+    std::ifstream f(path, std::ios::binary);
+    if (!f.is_open()) return false;
+    std::ostringstream ss;
+    ss << f.rdbuf();
+    out = ss.str();
+    return true;
+}
+
+std::string resolveInclude(const std::string& requesting,
+                           const std::string& requested) {
+    fs::path base = fs::path(requesting).parent_path();
+    return (base / requested).lexically_normal().string();
+}
+
+// Walk `#include "..."` directives so the cache key can cover included files
+// without running the preprocessor. Includes inside inactive #if blocks are
+// still hashed — harmless, it only makes the key more conservative.
+void collectIncludes(const std::string& name, const std::string& source,
+                     std::set<std::string>& seen,
+                     std::vector<std::string>& deps, uint64_t& hash) {
+    std::istringstream lines(source);
+    std::string line;
+    while (std::getline(lines, line)) {
+        size_t p = line.find_first_not_of(" \t");
+        if (p == std::string::npos || line.compare(p, 8, "#include") != 0)
+            continue;
+        size_t q0 = line.find('"', p + 8);
+        size_t q1 = q0 == std::string::npos ? q0 : line.find('"', q0 + 1);
+        if (q1 == std::string::npos) continue;
+
+        std::string path = resolveInclude(name, line.substr(q0 + 1, q1 - q0 - 1));
+        if (!seen.insert(path).second) continue;
+
+        std::string text;
+        if (!readText(path, text)) continue;  // shaderc reports the error
+        deps.push_back(path);
+        hash = hashBytes(path.data(), path.size(), hash);
+        hash = hashBytes(text.data(), text.size(), hash);
+        collectIncludes(path, text, seen, deps, hash);
+    }
+}
+
+class FileIncluder : public shaderc::CompileOptions::IncluderInterface {
+public:
+    shaderc_include_result* GetInclude(const char* requestedSource,
+                                       shaderc_include_type /*type*/,
+                                       const char* requestingSource,
+                                       size_t /*includeDepth*/) override {
+        auto* data = new Data;
+        data->name = resolveInclude(requestingSource, requestedSource);
+        if (!readText(data->name, data->content)) {
+            data->content = "cannot open include file: " + data->name;
+            data->name.clear();  // empty name signals failure to shaderc
+        }
+        data->result.source_name = data->name.c_str();
+        data->result.source_name_length = data->name.size();
+        data->result.content = data->content.c_str();
+        data->result.content_length = data->content.size();
+        data->result.user_data = data;
+        return &data->result;
+    }
+
+    void ReleaseInclude(shaderc_include_result* result) override {
+        delete static_cast<Data*>(result->user_data);
+    }
+
+private:
+    struct Data {
+        shaderc_include_result result{};
+        std::string name;
+        std::string content;
+    };
+};
+
+}  // namespace
+
+uint64_t hashBytes(const void* data, size_t size, uint64_t seed) {
+    const auto* p = static_cast<const unsigned char*>(data);
+    uint64_t h = seed;
+    for (size_t i = 0; i < size; ++i) {
+        h ^= p[i];
+        h *= 0x100000001b3ull;
+    }
+    return h;
+}
+
+// ---------- ShaderCompiler ----------
+
+ShaderCompiler::ShaderCompiler(std::string cacheDir)
+    : cacheDir_(std::move(cacheDir)) {
+    fs::create_directories(cacheDir_);
+}
+
+std::vector<uint32_t> ShaderCompiler::compileFile(
+    const std::string& path, const ShaderDefines& defines) {
+    std::string source;
+    if (!readText(path, source)) {
+        throw std::runtime_error("Cannot open shader: " + path);
+    }
+    return compileSource(source, path, defines);
+}
+
+std::vector<uint32_t> ShaderCompiler::compileSource(
+    const std::string& source, const std::string& name,
+    const ShaderDefines& defines) {
+    // --- Cache key ---
+    uint64_t key = hashBytes(kCacheTag, std::char_traits<char>::length(kCacheTag));
+    key = hashBytes(source.data(), source.size(), key);
+    for (auto& d : defines) {
+        key = hashBytes(d.first.data(), d.first.size(), key);
+        key = hashBytes("=", 1, key);
+        key = hashBytes(d.second.data(), d.second.size(), key);
+        key = hashBytes(";", 1, key);
+    }
+    deps_.clear();
+    deps_.push_back(name);
+    std::set<std::string> seen{name};
+    collectIncludes(name, source, seen, deps_, key);
+
+    char keyHex[17];
+    snprintf(keyHex, sizeof(keyHex), "%016llx",
+             static_cast<unsigned long long>(key));
+    fs::path cachePath = fs::path(cacheDir_) / (std::string(keyHex) + ".spv");
+
+    // --- Cache lookup ---
+    {
+        std::ifstream f(cachePath, std::ios::ate | std::ios::binary);
+        if (f.is_open()) {
+            size_t bytes = f.tellg();
+            if (bytes > 0 && bytes % sizeof(uint32_t) == 0) {
+                std::vector<uint32_t> spirv(bytes / sizeof(uint32_t));
+                f.seekg(0);
+                f.read(reinterpret_cast<char*>(spirv.data()), bytes);
+                if (f && spirv[0] == 0x07230203u) {  // SPIR-V magic
+                    lastHit_ = true;
+                    ++hits_;
+                    return spirv;
+                }
+            }
+        }
+    }
+
+    // --- Compile ---
+    shaderc::Compiler compiler;
+    shaderc::CompileOptions options;
+    options.SetTargetEnvironment(shaderc_target_env_vulkan,
+                                 shaderc_env_version_vulkan_1_2);
+    for (auto& d : defines) {
+        options.AddMacroDefinition(d.first, d.second);
+    }
+    options.SetIncluder(std::make_unique<FileIncluder>());
+
+    shaderc::SpvCompilationResult result = compiler.CompileGlslToSpv(
+        source, shaderc_compute_shader, name.c_str(), options);
+    if (result.GetCompilationStatus() != shaderc_compilation_status_success) {
+        throw std::runtime_error("GLSL compile failed (" + name + "):\n" +
+                                 result.GetErrorMessage());
+    }
+    std::vector<uint32_t> spirv(result.cbegin(), result.cend());
+
+    // --- Cache store (write-then-rename so readers never see a torn file) ---
+    fs::path tmpPath = cachePath;
+    tmpPath += ".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::binary);
+        out.write(reinterpret_cast<const char*>(spirv.data()),
+                  spirv.size() * sizeof(uint32_t));
+    }
+    std::error_code ec;
+    fs::rename(tmpPath, cachePath, ec);
+    if (ec) fs::remove(tmpPath, ec);
+
+    lastHit_ = false;
+    ++misses_;
+    return spirv;
+}
+
+// ---------- FileWatcher ----------
+
+namespace {
+
+int64_t modTime(const std::string& path) {
+    std::error_code ec;
+    auto t = fs::last_write_time(path, ec);
+    return ec ? 0 : static_cast<int64_t>(t.time_since_epoch().count());
+}
+
+}  // namespace
+
+FileWatcher::FileWatcher() {
+#if defined(__linux__)
+    fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#endif
+}
+
+FileWatcher::~FileWatcher() {
+    clear();
+#if defined(__linux__)
+    if (fd_ >= 0) close(fd_);
+#endif
+}
+
+void FileWatcher::watch(const std::string& path) {
+    for (auto& e : entries_) {
+        if (e.path == path) return;
+    }
+    Entry e;
+    e.path = path;
+    e.name = fs::path(path).filename().string();
+    e.mtime = modTime(path);
+#if defined(__linux__)
+    if (fd_ >= 0) {
+        std::string dir = fs::path(path).parent_path().string();
+        if (dir.empty()) dir = ".";
+        // inotify returns the existing descriptor for an already-watched dir
+        e.wd = inotify_add_watch(fd_, dir.c_str(),
+                                 IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+    }
+#endif
+    entries_.push_back(e);
+}
+
+void FileWatcher::clear() {
+#if defined(__linux__)
+    std::set<int> removed;
+    for (auto& e : entries_) {
+        if (e.wd >= 0 && removed.insert(e.wd).second) {
+            inotify_rm_watch(fd_, e.wd);
+        }
+    }
+#endif
+    entries_.clear();
+}
+
+std::vector<std::string> FileWatcher::poll() {
+    std::set<std::string> changed;
+
+#if defined(__linux__)
+    if (fd_ >= 0) {
+        alignas(inotify_event) char buf[4096];
+        for (;;) {
+            ssize_t n = read(fd_, buf, sizeof(buf));
+            if (n <= 0) break;
+            for (char* p = buf; p < buf + n;) {
+                auto* ev = reinterpret_cast<inotify_event*>(p);
+                if (ev->len > 0) {
+                    for (auto& e : entries_) {
+                        if (e.wd == ev->wd && e.name == ev->name) {
+                            changed.insert(e.path);
+                        }
+                    }
+                }
+                p += sizeof(inotify_event) + ev->len;
+            }
+        }
+        return {changed.begin(), changed.end()};
+    }
+#endif
+
+    for (auto& e : entries_) {
+        int64_t t = modTime(e.path);
+        if (t != e.mtime) {
+            e.mtime = t;
+            changed.insert(e.path);
+        }
+    }
+    return {changed.begin(), changed.end()};
+}
+
+}  // namespace vkutil
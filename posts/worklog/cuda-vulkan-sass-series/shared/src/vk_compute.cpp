@@ -0,0 +1,353 @@
+#include "vk_compute.h"
+#include "api_trace.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+#define VK_CHECK(call)                                                   \
+    do {                                                                 \
+        VkResult r = API_TRACE(call);                                    \
+        if (r != VK_SUCCESS) {                                           \
+            fprintf(stderr, "Vulkan error %d at %s:%d\n", r, __FILE__,  \
+                    __LINE__);                                           \
+            std::abort();                                                \
+        }                                                                \
+    } while (0)
+
+namespace vkutil {
+
+namespace {
+
+VkShaderModule createModule(VkDevice device,
+                            const std::vector<uint32_t>& spirv) {
+    VkShaderModuleCreateInfo smCI{
+        VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO};
+    smCI.codeSize = spirv.size() * sizeof(uint32_t);
+    smCI.pCode = spirv.data();
+
+    VkShaderModule module;
+    VK_CHECK(vkCreateShaderModule(device, &smCI, nullptr, &module));
+    return module;
+}
+
+VkPipeline createPipeline(VkDevice device, VkShaderModule module,
+                          VkPipelineLayout layout, VkPipelineCache cache,
+                          const VkSpecializationInfo* specialization) {
+    VkComputePipelineCreateInfo pipeCI{
+        VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO};
+    pipeCI.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    pipeCI.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    pipeCI.stage.module = module;
+    pipeCI.stage.pName = "main";
+    pipeCI.stage.pSpecializationInfo = specialization;
+    pipeCI.layout = layout;
+
+    VkPipeline pipeline;
+    VK_CHECK(vkCreateComputePipelines(device, cache, 1, &pipeCI, nullptr,
+                                      &pipeline));
+    return pipeline;
+}
+
+}  // namespace
+
+SpecConstants& SpecConstants::set(uint32_t id, uint32_t value) {
+    for (auto& e : entries) {
+        if (e.constantID == id) {
+            values[e.offset / sizeof(uint32_t)] = value;
+            return *this;
+        }
+    }
+    entries.push_back({id, static_cast<uint32_t>(values.size() *
+                                                 sizeof(uint32_t)),
+                       sizeof(uint32_t)});
+    values.push_back(value);
+    return *this;
+}
+
+SpecConstants& SpecConstants::set(uint32_t id, float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return set(id, bits);
+}
+
+const VkSpecializationInfo* SpecConstants::get() {
+    info.mapEntryCount = static_cast<uint32_t>(entries.size());
+    info.pMapEntries = entries.data();
+    info.dataSize = values.size() * sizeof(uint32_t);
+    info.pData = values.data();
+    return &info;
+}
+
+void ComputeKernel::destroy(VkDevice device) {
+    if (pipeline) API_TRACE(vkDestroyPipeline(device, pipeline, nullptr));
+    if (module) API_TRACE(vkDestroyShaderModule(device, module, nullptr));
+    if (descriptorPool)
+        API_TRACE(vkDestroyDescriptorPool(device, descriptorPool, nullptr));
+    if (layout) API_TRACE(vkDestroyPipelineLayout(device, layout, nullptr));
+    if (setLayout)
+        API_TRACE(vkDestroyDescriptorSetLayout(device, setLayout, nullptr));
+    *this = ComputeKernel{};
+}
+
+ComputeKernel createComputeKernel(
+    const VkContext& ctx, const std::vector<uint32_t>& spirv,
+    uint32_t bufferCount, uint32_t pushConstantSize, VkPipelineCache cache,
+    const VkSpecializationInfo* specialization) {
+    ComputeKernel k{};
+    k.bufferCount = bufferCount;
+    k.pushConstantSize = pushConstantSize;
+
+    // --- Descriptor set layout: storage buffers at 0..N-1 ---
+    std::vector<VkDescriptorSetLayoutBinding> bindings(bufferCount);
+    for (uint32_t i = 0; i < bufferCount; ++i) {
+        bindings[i].binding = i;
+        bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[i].descriptorCount = 1;
+        bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    }
+    VkDescriptorSetLayoutCreateInfo setCI{
+        VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO};
+    setCI.bindingCount = bufferCount;
+    setCI.pBindings = bindings.data();
+    VK_CHECK(vkCreateDescriptorSetLayout(ctx.device, &setCI, nullptr,
+                                         &k.setLayout));
+
+    // --- Pipeline layout ---
+    VkPushConstantRange pcRange{VK_SHADER_STAGE_COMPUTE_BIT, 0,
+                                pushConstantSize};
+    VkPipelineLayoutCreateInfo layoutCI{
+        VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO};
+    layoutCI.setLayoutCount = 1;
+    layoutCI.pSetLayouts = &k.setLayout;
+    if (pushConstantSize > 0) {
+        layoutCI.pushConstantRangeCount = 1;
+        layoutCI.pPushConstantRanges = &pcRange;
+    }
+    VK_CHECK(vkCreatePipelineLayout(ctx.device, &layoutCI, nullptr,
+                                    &k.layout));
+
+    // --- Descriptor pool + set ---
+    if (bufferCount > 0) {
+        VkDescriptorPoolSize poolSize{VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                                      bufferCount};
+        VkDescriptorPoolCreateInfo poolCI{
+            VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO};
+        poolCI.maxSets = 1;
+        poolCI.poolSizeCount = 1;
+        poolCI.pPoolSizes = &poolSize;
+        VK_CHECK(vkCreateDescriptorPool(ctx.device, &poolCI, nullptr,
+                                        &k.descriptorPool));
+
+        VkDescriptorSetAllocateInfo allocInfo{
+            VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO};
+        allocInfo.descriptorPool = k.descriptorPool;
+        allocInfo.descriptorSetCount = 1;
+        allocInfo.pSetLayouts = &k.setLayout;
+        VK_CHECK(vkAllocateDescriptorSets(ctx.device, &allocInfo,
+                                          &k.descriptorSet));
+    }
+
+    // --- Pipeline ---
+    k.module = createModule(ctx.device, spirv);
+    k.pipeline = createPipeline(ctx.device, k.module, k.layout, cache,
+                                specialization);
+    return k;
+}
+
+void reloadComputeKernel(const VkContext& ctx, ComputeKernel& kernel,
+                         const std::vector<uint32_t>& spirv,
+                         VkPipelineCache cache,
+                         const VkSpecializationInfo* specialization) {
+    // Build the replacement first so a failure leaves the old kernel intact.
+    VkShaderModule module = createModule(ctx.device, spirv);
+    VkPipeline pipeline = createPipeline(ctx.device, module, kernel.layout,
+                                         cache, specialization);
+
+    API_TRACE(vkDestroyPipeline(ctx.device, kernel.pipeline, nullptr));
+    API_TRACE(vkDestroyShaderModule(ctx.device, kernel.module, nullptr));
+    kernel.module = module;
+    kernel.pipeline = pipeline;
+}
+
+void bindStorageBuffers(const VkContext& ctx, const ComputeKernel& kernel,
+                        const std::vector<VkBuffer>& buffers) {
+    std::vector<VkDescriptorBufferInfo> infos(buffers.size());
+    std::vector<VkWriteDescriptorSet> writes(buffers.size());
+    for (size_t i = 0; i < buffers.size(); ++i) {
+        infos[i] = {buffers[i], 0, VK_WHOLE_SIZE};
+        writes[i] = {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
+        writes[i].dstSet = kernel.descriptorSet;
+        writes[i].dstBinding = static_cast<uint32_t>(i);
+        writes[i].descriptorCount = 1;
+        writes[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        writes[i].pBufferInfo = &infos[i];
+    }
+    API_TRACE(vkUpdateDescriptorSets(ctx.device,
+                                     static_cast<uint32_t>(writes.size()),
+                                     writes.data(), 0, nullptr));
+}
+
+namespace {
+
+void bindKernel(VkCommandBuffer cmd, const ComputeKernel& kernel,
+                const void* pushData,
+                VkDescriptorSet set = VK_NULL_HANDLE) {
+    API_TRACE(vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE,
+                                kernel.pipeline));
+    if (!set) set = kernel.descriptorSet;
+    if (set) {
+        API_TRACE(vkCmdBindDescriptorSets(
+            cmd, VK_PIPELINE_BIND_POINT_COMPUTE, kernel.layout, 0, 1, &set, 0,
+            nullptr));
+    }
+    if (kernel.pushConstantSize > 0 && pushData) {
+        API_TRACE(vkCmdPushConstants(cmd, kernel.layout,
+                                     VK_SHADER_STAGE_COMPUTE_BIT, 0,
+                                     kernel.pushConstantSize, pushData));
+    }
+}
+
+}  // namespace
+
+void recordDispatch(VkCommandBuffer cmd, const ComputeKernel& kernel,
+                    const void* pushData, uint32_t groupsX,
+                    uint32_t groupsY, uint32_t groupsZ) {
+    bindKernel(cmd, kernel, pushData);
+    API_TRACE(vkCmdDispatch(cmd, groupsX, groupsY, groupsZ));
+}
+
+void recordDispatchIndirect(VkCommandBuffer cmd, const ComputeKernel& kernel,
+                            const void* pushData, VkBuffer indirectBuffer,
+                            VkDeviceSize offset) {
+    bindKernel(cmd, kernel, pushData);
+    API_TRACE(vkCmdDispatchIndirect(cmd, indirectBuffer, offset));
+}
+
+void recordComputeBarrier(VkCommandBuffer cmd) {
+    VkMemoryBarrier barrier{VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+    barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT |
+                            VK_ACCESS_SHADER_WRITE_BIT;
+    API_TRACE(vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                   VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1,
+                                   &barrier, 0, nullptr, 0, nullptr));
+}
+
+// ---------- Large arrays ----------
+
+uint32_t gridStrideGroups(uint64_t n, uint32_t localSize, uint32_t maxGroups) {
+    uint64_t groups = n / localSize + (n % localSize != 0);
+    return static_cast<uint32_t>(std::max<uint64_t>(
+        1, std::min<uint64_t>(groups, maxGroups)));
+}
+
+void ChunkedBindings::destroy(VkDevice device) {
+    if (pool) API_TRACE(vkDestroyDescriptorPool(device, pool, nullptr));
+    pool = VK_NULL_HANDLE;
+    sets.clear();
+    chunks.clear();
+}
+
+ChunkedBindings bindStorageBufferChunks(const VkContext& ctx,
+                                        const ComputeKernel& kernel,
+                                        const std::vector<VkBuffer>& buffers,
+                                        const std::vector<uint32_t>& elemSizes,
+                                        uint64_t n,
+                                        VkDeviceSize maxWindowBytes) {
+    if (buffers.size() != elemSizes.size() || buffers.empty()) {
+        throw std::runtime_error(
+            "bindStorageBufferChunks: one element size per buffer required");
+    }
+    if (maxWindowBytes == 0 || maxWindowBytes > ctx.maxStorageBufferRange) {
+        maxWindowBytes = ctx.maxStorageBufferRange;
+    }
+
+    // Window length in elements: fits every binding, stays below 2^31 so a
+    // uint32 `idx + stride` in the kernel's loop cannot wrap, and is a
+    // multiple of the offset alignment (in elements, so first * elemSize
+    // stays aligned for any element size).
+    uint32_t widest = *std::max_element(elemSizes.begin(), elemSizes.end());
+    uint64_t align =
+        std::max<VkDeviceSize>(1, ctx.minStorageBufferOffsetAlignment);
+    uint64_t window =
+        std::min<uint64_t>(maxWindowBytes / widest, uint64_t(1) << 31);
+    window -= window % align;
+    if (window == 0) {
+        throw std::runtime_error(
+            "bindStorageBufferChunks: window smaller than offset alignment");
+    }
+
+    ChunkedBindings b;
+    for (uint64_t first = 0; first < n; first += window) {
+        b.chunks.push_back(
+            {first, static_cast<uint32_t>(std::min(window, n - first))});
+    }
+    if (b.chunks.empty()) return b;
+
+    uint32_t chunkCount = static_cast<uint32_t>(b.chunks.size());
+    uint32_t bindingCount = static_cast<uint32_t>(buffers.size());
+    VkDescriptorPoolSize poolSize{VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                                  chunkCount * bindingCount};
+    VkDescriptorPoolCreateInfo poolCI{
+        VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO};
+    poolCI.maxSets = chunkCount;
+    poolCI.poolSizeCount = 1;
+    poolCI.pPoolSizes = &poolSize;
+    VK_CHECK(vkCreateDescriptorPool(ctx.device, &poolCI, nullptr, &b.pool));
+
+    std::vector<VkDescriptorSetLayout> layouts(chunkCount, kernel.setLayout);
+    VkDescriptorSetAllocateInfo allocInfo{
+        VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO};
+    allocInfo.descriptorPool = b.pool;
+    allocInfo.descriptorSetCount = chunkCount;
+    allocInfo.pSetLayouts = layouts.data();
+    b.sets.resize(chunkCount);
+    VK_CHECK(vkAllocateDescriptorSets(ctx.device, &allocInfo, b.sets.data()));
+
+    std::vector<VkDescriptorBufferInfo> infos(size_t(chunkCount) *
+                                              bindingCount);
+    std::vector<VkWriteDescriptorSet> writes(infos.size());
+    for (uint32_t c = 0; c < chunkCount; ++c) {
+        for (uint32_t k = 0; k < bindingCount; ++k) {
+            size_t i = size_t(c) * bindingCount + k;
+            infos[i] = {buffers[k], b.chunks[c].first * elemSizes[k],
+                        VkDeviceSize(b.chunks[c].count) * elemSizes[k]};
+            writes[i] = {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
+            writes[i].dstSet = b.sets[c];
+            writes[i].dstBinding = k;
+            writes[i].descriptorCount = 1;
+            writes[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            writes[i].pBufferInfo = &infos[i];
+        }
+    }
+    API_TRACE(vkUpdateDescriptorSets(ctx.device,
+                                     static_cast<uint32_t>(writes.size()),
+                                     writes.data(), 0, nullptr));
+    return b;
+}
+
+void recordChunkedDispatch(VkCommandBuffer cmd, const ComputeKernel& kernel,
+                           const ChunkedBindings& bindings,
+                           const void* pushData, uint32_t countOffset,
+                           uint32_t localSize, uint32_t maxGroups) {
+    if (countOffset + sizeof(uint32_t) > kernel.pushConstantSize) {
+        throw std::runtime_error(
+            "recordChunkedDispatch: count offset outside the push block");
+    }
+    std::vector<uint8_t> push(kernel.pushConstantSize);
+    if (pushData) memcpy(push.data(), pushData, push.size());
+
+    for (size_t c = 0; c < bindings.chunks.size(); ++c) {
+        uint32_t count = bindings.chunks[c].count;
+        memcpy(push.data() + countOffset, &count, sizeof(count));
+        bindKernel(cmd, kernel, push.data(), bindings.sets[c]);
+        API_TRACE(vkCmdDispatch(cmd, gridStrideGroups(count, localSize,
+                                                      maxGroups),
+                                1, 1));
+    }
+}
+
+}  // namespace vkutil
@@ -1,12 +1,17 @@
 #include "vk_init.h"
+#include "api_trace.h"
+#include <chrono>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <fstream>
+#include <map>
+#include <mutex>
 #include <stdexcept>
 
 #define VK_CHECK(call)                                                   \
     do {                                                                 \
-        VkResult r = (call);                                             \
+        VkResult r = API_TRACE(call);                                    \
         if (r != VK_SUCCESS) {                                           \
             fprintf(stderr, "Vulkan error %d at %s:%d\n", r, __FILE__,  \
                     __LINE__);                                           \
@@ -17,56 +22,171 @@
 namespace vkutil {
 
 void VkContext::destroy() {
-    if (device) vkDestroyDevice(device, nullptr);
-    if (instance) vkDestroyInstance(instance, nullptr);
+    if (device) API_TRACE(vkDestroyDevice(device, nullptr));
+    if (instance) API_TRACE(vkDestroyInstance(instance, nullptr));
     device = VK_NULL_HANDLE;
     instance = VK_NULL_HANDLE;
 }
 
-VkContext createComputeContext(bool enablePipelineExecProps) {
-    VkContext ctx{};
+namespace {
 
-    // --- Instance ---
-    VkApplicationInfo appInfo{VK_STRUCTURE_TYPE_APPLICATION_INFO};
-    appInfo.pApplicationName = "sass-series";
-    appInfo.apiVersion = VK_API_VERSION_1_2;
+using Clock = std::chrono::high_resolution_clock;
 
-    VkInstanceCreateInfo instCI{VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO};
-    instCI.pApplicationInfo = &appInfo;
-    VK_CHECK(vkCreateInstance(&instCI, nullptr, &ctx.instance));
+double msSince(Clock::time_point t0) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - t0)
+        .count();
+}
 
-    // --- Physical device (prefer NVIDIA discrete) ---
-    uint32_t gpuCount = 0;
-    vkEnumeratePhysicalDevices(ctx.instance, &gpuCount, nullptr);
-    std::vector<VkPhysicalDevice> gpus(gpuCount);
-    vkEnumeratePhysicalDevices(ctx.instance, &gpuCount, gpus.data());
+// What the selection cache remembers: the device, identified by its
+// enumeration index and checked against vendor/device/driver, plus the
+// answers to every capability query made during selection.
+struct DeviceSelection {
+    uint32_t index = 0;
+    uint32_t vendorID = 0;
+    uint32_t deviceID = 0;
+    uint32_t driverVersion = 0;
+    uint32_t computeQueueFamily = 0;
+    bool hasExternalMemoryHost = false;
+    VkDeviceSize minImportedHostPointerAlignment = 0;
+    bool hasStorage16 = false;
+    bool hasStorage8 = false;
+    bool hasFloat16 = false;
+    bool hasInt8 = false;
+    bool hasShaderClock = false;
+};
+
+// Bumped whenever DeviceSelection changes.
+constexpr const char* kSelectionTag = "sass-series-device-v2";
+
+bool loadSelection(const std::string& path, DeviceSelection& sel) {
+    std::ifstream in(path);
+    std::string tag;
+    if (!(in >> tag) || tag != kSelectionTag) return false;
+    std::map<std::string, unsigned long long> kv;
+    std::string key;
+    unsigned long long value;
+    while (in >> key >> value) kv[key] = value;
+
+    const char* required[] = {"index", "vendor", "device", "driver",
+                              "queueFamily", "externalMemoryHost",
+                              "hostPointerAlignment", "storage16",
+                              "storage8", "float16", "int8",
+                              "shaderClock"};
+    for (const char* k : required) {
+        if (!kv.count(k)) return false;
+    }
+    sel.index = static_cast<uint32_t>(kv["index"]);
+    sel.vendorID = static_cast<uint32_t>(kv["vendor"]);
+    sel.deviceID = static_cast<uint32_t>(kv["device"]);
+    sel.driverVersion = static_cast<uint32_t>(kv["driver"]);
+    sel.computeQueueFamily = static_cast<uint32_t>(kv["queueFamily"]);
+    sel.hasExternalMemoryHost = kv["externalMemoryHost"] != 0;
+    sel.minImportedHostPointerAlignment = kv["hostPointerAlignment"];
+    sel.hasStorage16 = kv["storage16"] != 0;
+    sel.hasStorage8 = kv["storage8"] != 0;
+    sel.hasFloat16 = kv["float16"] != 0;
+    sel.hasInt8 = kv["int8"] != 0;
+    sel.hasShaderClock = kv["shaderClock"] != 0;
+    return true;
+}
 
-    for (auto& gpu : gpus) {
+// Write-then-rename so a concurrent reader never sees a torn file. A
+// failed write only costs the next run its cache hit.
+void storeSelection(const std::string& path, const DeviceSelection& sel) {
+    std::string tmp = path + ".tmp";
+    {
+        std::ofstream out(tmp);
+        out << kSelectionTag << "\n"
+            << "index " << sel.index << "\n"
+            << "vendor " << sel.vendorID << "\n"
+            << "device " << sel.deviceID << "\n"
+            << "driver " << sel.driverVersion << "\n"
+            << "queueFamily " << sel.computeQueueFamily << "\n"
+            << "externalMemoryHost " << sel.hasExternalMemoryHost << "\n"
+            << "hostPointerAlignment " << sel.minImportedHostPointerAlignment
+            << "\n"
+            << "storage16 " << sel.hasStorage16 << "\n"
+            << "storage8 " << sel.hasStorage8 << "\n"
+            << "float16 " << sel.hasFloat16 << "\n"
+            << "int8 " << sel.hasInt8 << "\n"
+            << "shaderClock " << sel.hasShaderClock << "\n";
+    }
+    if (std::rename(tmp.c_str(), path.c_str()) != 0) std::remove(tmp.c_str());
+}
+
+// Prefer an NVIDIA discrete GPU, else the first one.
+uint32_t pickDevice(const std::vector<VkPhysicalDevice>& gpus) {
+    for (uint32_t i = 0; i < gpus.size(); ++i) {
         VkPhysicalDeviceProperties props;
-        vkGetPhysicalDeviceProperties(gpu, &props);
+        API_TRACE(vkGetPhysicalDeviceProperties(gpus[i], &props));
         if (props.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU &&
             props.vendorID == 0x10DE) {
-            ctx.physicalDevice = gpu;
-            printf("Selected GPU: %s\n", props.deviceName);
-            break;
+            return i;
         }
     }
-    if (!ctx.physicalDevice && gpuCount > 0) {
-        ctx.physicalDevice = gpus[0];
+    return 0;
+}
+
+// Every capability query the context needs, for a cache miss.
+void queryCapabilities(VkContext& ctx, bool hasVk12) {
+    uint32_t extCount = 0;
+    API_TRACE(vkEnumerateDeviceExtensionProperties(
+        ctx.physicalDevice, nullptr, &extCount, nullptr));
+    std::vector<VkExtensionProperties> availExts(extCount);
+    API_TRACE(vkEnumerateDeviceExtensionProperties(
+        ctx.physicalDevice, nullptr, &extCount, availExts.data()));
+    bool hasClockExt = false;
+    for (auto& e : availExts) {
+        if (!strcmp(e.extensionName,
+                    VK_EXT_EXTERNAL_MEMORY_HOST_EXTENSION_NAME)) {
+            ctx.hasExternalMemoryHost = true;
+        }
+        if (!strcmp(e.extensionName, VK_KHR_SHADER_CLOCK_EXTENSION_NAME)) {
+            hasClockExt = true;
+        }
     }
-    if (!ctx.physicalDevice) {
-        throw std::runtime_error("No Vulkan GPU found");
+
+    if (ctx.hasExternalMemoryHost) {
+        VkPhysicalDeviceExternalMemoryHostPropertiesEXT hostProps{
+            VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTERNAL_MEMORY_HOST_PROPERTIES_EXT};
+        VkPhysicalDeviceProperties2 props2{
+            VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2};
+        props2.pNext = &hostProps;
+        API_TRACE(vkGetPhysicalDeviceProperties2(ctx.physicalDevice, &props2));
+        ctx.minImportedHostPointerAlignment =
+            hostProps.minImportedHostPointerAlignment;
     }
 
-    vkGetPhysicalDeviceMemoryProperties(ctx.physicalDevice, &ctx.memProps);
+    // --- Reduced-precision features (Vulkan 1.2 feature structs) and
+    //     shader clock ---
+    if (hasVk12) {
+        VkPhysicalDeviceVulkan11Features supported11{
+            VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_1_FEATURES};
+        VkPhysicalDeviceVulkan12Features supported12{
+            VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES};
+        VkPhysicalDeviceShaderClockFeaturesKHR supportedClock{
+            VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SHADER_CLOCK_FEATURES_KHR};
+        supported11.pNext = &supported12;
+        if (hasClockExt) supported12.pNext = &supportedClock;
+        VkPhysicalDeviceFeatures2 query{
+            VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2};
+        query.pNext = &supported11;
+        API_TRACE(vkGetPhysicalDeviceFeatures2(ctx.physicalDevice, &query));
+
+        ctx.hasStorage16 = supported11.storageBuffer16BitAccess;
+        ctx.hasStorage8 = supported12.storageBuffer8BitAccess;
+        ctx.hasFloat16 = supported12.shaderFloat16;
+        ctx.hasInt8 = supported12.shaderInt8;
+        ctx.hasShaderClock = hasClockExt && supportedClock.shaderSubgroupClock;
+    }
 
     // --- Queue family (compute) ---
     uint32_t qfCount = 0;
-    vkGetPhysicalDeviceQueueFamilyProperties(ctx.physicalDevice, &qfCount,
-                                             nullptr);
+    API_TRACE(vkGetPhysicalDeviceQueueFamilyProperties(
+        ctx.physicalDevice, &qfCount, nullptr));
     std::vector<VkQueueFamilyProperties> qfProps(qfCount);
-    vkGetPhysicalDeviceQueueFamilyProperties(ctx.physicalDevice, &qfCount,
-                                             qfProps.data());
+    API_TRACE(vkGetPhysicalDeviceQueueFamilyProperties(
+        ctx.physicalDevice, &qfCount, qfProps.data()));
 
     for (uint32_t i = 0; i < qfCount; ++i) {
         if (qfProps[i].queueFlags & VK_QUEUE_COMPUTE_BIT) {
@@ -74,8 +194,114 @@ VkContext createComputeContext(bool enablePipelineExecProps) {
             break;
         }
     }
+}
+
+}  // namespace
+
+VkContext createComputeContext(bool enablePipelineExecProps) {
+    ContextOptions opts;
+    opts.enablePipelineExecProps = enablePipelineExecProps;
+    opts.selectionCache.clear();
+    return createComputeContext(opts);
+}
+
+VkContext createComputeContext(const ContextOptions& opts) {
+    VkContext ctx{};
+    auto tStart = Clock::now();
+
+    // --- Instance ---
+    auto t0 = Clock::now();
+    VkApplicationInfo appInfo{VK_STRUCTURE_TYPE_APPLICATION_INFO};
+    appInfo.pApplicationName = "sass-series";
+    appInfo.apiVersion = VK_API_VERSION_1_2;
+
+    VkInstanceCreateInfo instCI{VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO};
+    instCI.pApplicationInfo = &appInfo;
+    instCI.enabledLayerCount =
+        static_cast<uint32_t>(opts.instanceLayers.size());
+    instCI.ppEnabledLayerNames = opts.instanceLayers.data();
+    instCI.enabledExtensionCount =
+        static_cast<uint32_t>(opts.instanceExtensions.size());
+    instCI.ppEnabledExtensionNames = opts.instanceExtensions.data();
+    VK_CHECK(vkCreateInstance(&instCI, nullptr, &ctx.instance));
+    ctx.bringUp.instanceMs = msSince(t0);
+
+    // --- Physical device ---
+    t0 = Clock::now();
+    uint32_t gpuCount = 0;
+    API_TRACE(vkEnumeratePhysicalDevices(ctx.instance, &gpuCount, nullptr));
+    std::vector<VkPhysicalDevice> gpus(gpuCount);
+    API_TRACE(vkEnumeratePhysicalDevices(ctx.instance, &gpuCount, gpus.data()));
+    ctx.bringUp.enumerateMs = msSince(t0);
+    if (gpuCount == 0) {
+        throw std::runtime_error("No Vulkan GPU found");
+    }
+
+    // A cache hit needs only the chosen device's properties (for limits);
+    // a miss, or a changed device or driver, redoes every query.
+    t0 = Clock::now();
+    DeviceSelection sel;
+    VkPhysicalDeviceProperties devProps;
+    bool cached = !opts.selectionCache.empty() &&
+                  loadSelection(opts.selectionCache, sel) &&
+                  sel.index < gpuCount;
+    if (cached) {
+        API_TRACE(vkGetPhysicalDeviceProperties(gpus[sel.index], &devProps));
+        cached = devProps.vendorID == sel.vendorID &&
+                 devProps.deviceID == sel.deviceID &&
+                 devProps.driverVersion == sel.driverVersion;
+    }
+    bool hasVk12;
+    if (cached) {
+        ctx.physicalDevice = gpus[sel.index];
+        hasVk12 = devProps.apiVersion >= VK_API_VERSION_1_2;
+        ctx.computeQueueFamily = sel.computeQueueFamily;
+        ctx.hasExternalMemoryHost = sel.hasExternalMemoryHost;
+        ctx.minImportedHostPointerAlignment =
+            sel.minImportedHostPointerAlignment;
+        ctx.hasStorage16 = sel.hasStorage16;
+        ctx.hasStorage8 = sel.hasStorage8;
+        ctx.hasFloat16 = sel.hasFloat16;
+        ctx.hasInt8 = sel.hasInt8;
+        ctx.hasShaderClock = sel.hasShaderClock;
+    } else {
+        sel.index = pickDevice(gpus);
+        ctx.physicalDevice = gpus[sel.index];
+        API_TRACE(vkGetPhysicalDeviceProperties(ctx.physicalDevice,
+                                                &devProps));
+        hasVk12 = devProps.apiVersion >= VK_API_VERSION_1_2;
+        queryCapabilities(ctx, hasVk12);
+    }
+    printf("Selected GPU: %s%s\n", devProps.deviceName,
+           cached ? " (cached selection)" : "");
+
+    API_TRACE(vkGetPhysicalDeviceMemoryProperties(ctx.physicalDevice,
+                                                  &ctx.memProps));
+    ctx.maxStorageBufferRange = devProps.limits.maxStorageBufferRange;
+    ctx.minStorageBufferOffsetAlignment =
+        devProps.limits.minStorageBufferOffsetAlignment;
+    ctx.maxComputeWorkGroupCountX = devProps.limits.maxComputeWorkGroupCount[0];
+    ctx.bringUp.selectMs = msSince(t0);
+    ctx.bringUp.selectionCached = cached;
+
+    if (!cached && !opts.selectionCache.empty()) {
+        sel.vendorID = devProps.vendorID;
+        sel.deviceID = devProps.deviceID;
+        sel.driverVersion = devProps.driverVersion;
+        sel.computeQueueFamily = ctx.computeQueueFamily;
+        sel.hasExternalMemoryHost = ctx.hasExternalMemoryHost;
+        sel.minImportedHostPointerAlignment =
+            ctx.minImportedHostPointerAlignment;
+        sel.hasStorage16 = ctx.hasStorage16;
+        sel.hasStorage8 = ctx.hasStorage8;
+        sel.hasFloat16 = ctx.hasFloat16;
+        sel.hasInt8 = ctx.hasInt8;
+        sel.hasShaderClock = ctx.hasShaderClock;
+        storeSelection(opts.selectionCache, sel);
+    }
 
     // --- Logical device ---
+    t0 = Clock::now();
     float priority = 1.0f;
     VkDeviceQueueCreateInfo qCI{VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO};
     qCI.queueFamilyIndex = ctx.computeQueueFamily;
@@ -83,22 +309,52 @@ VkContext createComputeContext(bool enablePipelineExecProps) {
     qCI.pQueuePriorities = &priority;
 
     std::vector<const char*> deviceExts;
-    if (enablePipelineExecProps) {
+    if (opts.enablePipelineExecProps) {
         deviceExts.push_back(
             VK_KHR_PIPELINE_EXECUTABLE_PROPERTIES_EXTENSION_NAME);
+        ctx.hasPipelineExecProps = true;
+    }
+    if (ctx.hasExternalMemoryHost) {
+        deviceExts.push_back(VK_EXT_EXTERNAL_MEMORY_HOST_EXTENSION_NAME);
+    }
+    if (ctx.hasShaderClock) {
+        deviceExts.push_back(VK_KHR_SHADER_CLOCK_EXTENSION_NAME);
     }
 
     VkPhysicalDeviceFeatures2 features2{
         VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2};
 
+    // Enable only the reduced-precision bits, not everything supported
+    VkPhysicalDeviceVulkan11Features enable11{
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_1_FEATURES};
+    enable11.storageBuffer16BitAccess = ctx.hasStorage16;
+    VkPhysicalDeviceVulkan12Features enable12{
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES};
+    enable12.storageBuffer8BitAccess = ctx.hasStorage8;
+    enable12.shaderFloat16 = ctx.hasFloat16;
+    enable12.shaderInt8 = ctx.hasInt8;
+    if (hasVk12) {
+        enable11.pNext = &enable12;
+        features2.pNext = &enable11;
+    }
+
     VkPhysicalDevicePipelineExecutablePropertiesFeaturesKHR execFeat{
         VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PIPELINE_EXECUTABLE_PROPERTIES_FEATURES_KHR};
     execFeat.pipelineExecutableInfo = VK_TRUE;
 
-    if (enablePipelineExecProps) {
+    if (opts.enablePipelineExecProps) {
+        execFeat.pNext = features2.pNext;
         features2.pNext = &execFeat;
     }
 
+    VkPhysicalDeviceShaderClockFeaturesKHR clockFeat{
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SHADER_CLOCK_FEATURES_KHR};
+    clockFeat.shaderSubgroupClock = VK_TRUE;
+    if (ctx.hasShaderClock) {
+        clockFeat.pNext = features2.pNext;
+        features2.pNext = &clockFeat;
+    }
+
     VkDeviceCreateInfo devCI{VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO};
     devCI.pNext = &features2;
     devCI.queueCreateInfoCount = 1;
@@ -107,12 +363,51 @@ VkContext createComputeContext(bool enablePipelineExecProps) {
     devCI.ppEnabledExtensionNames = deviceExts.data();
 
     VK_CHECK(vkCreateDevice(ctx.physicalDevice, &devCI, nullptr, &ctx.device));
-    vkGetDeviceQueue(ctx.device, ctx.computeQueueFamily, 0,
-                     &ctx.computeQueue);
+    API_TRACE(vkGetDeviceQueue(ctx.device, ctx.computeQueueFamily, 0,
+                               &ctx.computeQueue));
+    ctx.bringUp.deviceMs = msSince(t0);
+    ctx.bringUp.totalMs = msSince(tStart);
+
+    return ctx;
+}
+
+std::future<VkContext> createComputeContextAsync(ContextOptions opts) {
+    return std::async(std::launch::async, [opts = std::move(opts)] {
+        return createComputeContext(opts);
+    });
+}
 
+std::shared_ptr<const VkContext> sharedComputeContext(
+    const ContextOptions& opts) {
+    static std::mutex mutex;
+    static std::weak_ptr<const VkContext> shared;
+
+    // Held across creation, so concurrent callers wait for the one bring-up
+    std::lock_guard<std::mutex> lock(mutex);
+    if (auto ctx = shared.lock()) {
+        if (opts.enablePipelineExecProps && !ctx->hasPipelineExecProps) {
+            throw std::runtime_error(
+                "sharedComputeContext: the shared context was created "
+                "without VK_KHR_pipeline_executable_properties");
+        }
+        return ctx;
+    }
+    auto ctx = std::shared_ptr<VkContext>(
+        new VkContext(createComputeContext(opts)), [](VkContext* c) {
+            c->destroy();
+            delete c;
+        });
+    shared = ctx;
     return ctx;
 }
 
+std::future<std::shared_ptr<const VkContext>> sharedComputeContextAsync(
+    ContextOptions opts) {
+    return std::async(std::launch::async, [opts = std::move(opts)] {
+        return sharedComputeContext(opts);
+    });
+}
+
 uint32_t findMemoryType(const VkContext& ctx, uint32_t typeFilter,
                         VkMemoryPropertyFlags properties) {
     for (uint32_t i = 0; i < ctx.memProps.memoryTypeCount; ++i) {
@@ -125,9 +420,79 @@ uint32_t findMemoryType(const VkContext& ctx, uint32_t typeFilter,
     throw std::runtime_error("Failed to find suitable memory type");
 }
 
+namespace {
+
+VkBuffer allocateBuffer(const VkContext& ctx, VkDeviceSize size,
+                        VkBufferUsageFlags usage,
+                        VkMemoryPropertyFlags properties,
+                        VkDeviceMemory& memory) {
+    VkBufferCreateInfo bufCI{VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO};
+    bufCI.size = size;
+    bufCI.usage = usage;
+    bufCI.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    VkBuffer buffer;
+    VK_CHECK(vkCreateBuffer(ctx.device, &bufCI, nullptr, &buffer));
+
+    VkMemoryRequirements memReqs;
+    API_TRACE(vkGetBufferMemoryRequirements(ctx.device, buffer, &memReqs));
+
+    VkMemoryAllocateInfo allocInfo{VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO};
+    allocInfo.allocationSize = memReqs.size;
+    allocInfo.memoryTypeIndex =
+        findMemoryType(ctx, memReqs.memoryTypeBits, properties);
+
+    VK_CHECK(vkAllocateMemory(ctx.device, &allocInfo, nullptr, &memory));
+    VK_CHECK(vkBindBufferMemory(ctx.device, buffer, memory, 0));
+
+    return buffer;
+}
+
+}  // namespace
+
 VkBuffer createBuffer(const VkContext& ctx, VkDeviceSize size,
                       VkBufferUsageFlags usage, VkDeviceMemory& memory) {
+    return allocateBuffer(ctx, size, usage,
+                          VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                              VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                          memory);
+}
+
+VkBuffer createDeviceLocalBuffer(const VkContext& ctx, VkDeviceSize size,
+                                 VkBufferUsageFlags usage,
+                                 VkDeviceMemory& memory) {
+    return allocateBuffer(ctx, size, usage,
+                          VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, memory);
+}
+
+VkBuffer importHostBuffer(const VkContext& ctx, void* ptr, VkDeviceSize size,
+                          VkBufferUsageFlags usage, VkDeviceMemory& memory) {
+    if (!ctx.hasExternalMemoryHost) {
+        throw std::runtime_error("VK_EXT_external_memory_host not supported");
+    }
+    VkDeviceSize align = ctx.minImportedHostPointerAlignment;
+    if (reinterpret_cast<uintptr_t>(ptr) % align != 0 || size % align != 0) {
+        throw std::runtime_error(
+            "Host pointer/size not aligned to minImportedHostPointerAlignment");
+    }
+
+    auto getHostPtrProps =
+        reinterpret_cast<PFN_vkGetMemoryHostPointerPropertiesEXT>(
+            vkGetDeviceProcAddr(ctx.device,
+                                "vkGetMemoryHostPointerPropertiesEXT"));
+    const auto handleType =
+        VK_EXTERNAL_MEMORY_HANDLE_TYPE_HOST_ALLOCATION_BIT_EXT;
+
+    VkMemoryHostPointerPropertiesEXT ptrProps{
+        VK_STRUCTURE_TYPE_MEMORY_HOST_POINTER_PROPERTIES_EXT};
+    VK_CHECK(getHostPtrProps(ctx.device, handleType, ptr, &ptrProps));
+
+    VkExternalMemoryBufferCreateInfo extBufCI{
+        VK_STRUCTURE_TYPE_EXTERNAL_MEMORY_BUFFER_CREATE_INFO};
+    extBufCI.handleTypes = handleType;
+
     VkBufferCreateInfo bufCI{VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO};
+    bufCI.pNext = &extBufCI;
     bufCI.size = size;
     bufCI.usage = usage;
     bufCI.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
@@ -136,14 +501,34 @@ VkBuffer createBuffer(const VkContext& ctx, VkDeviceSize size,
     VK_CHECK(vkCreateBuffer(ctx.device, &bufCI, nullptr, &buffer));
 
     VkMemoryRequirements memReqs;
-    vkGetBufferMemoryRequirements(ctx.device, buffer, &memReqs);
+    API_TRACE(vkGetBufferMemoryRequirements(ctx.device, buffer, &memReqs));
+
+    // Prefer a coherent type so neither side needs flush/invalidate
+    uint32_t typeBits = memReqs.memoryTypeBits & ptrProps.memoryTypeBits;
+    uint32_t typeIndex = UINT32_MAX;
+    for (uint32_t i = 0; i < ctx.memProps.memoryTypeCount; ++i) {
+        if (!(typeBits & (1u << i))) continue;
+        if (typeIndex == UINT32_MAX) typeIndex = i;
+        if (ctx.memProps.memoryTypes[i].propertyFlags &
+            VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) {
+            typeIndex = i;
+            break;
+        }
+    }
+    if (typeIndex == UINT32_MAX) {
+        API_TRACE(vkDestroyBuffer(ctx.device, buffer, nullptr));
+        throw std::runtime_error("No memory type can import this host pointer");
+    }
+
+    VkImportMemoryHostPointerInfoEXT importInfo{
+        VK_STRUCTURE_TYPE_IMPORT_MEMORY_HOST_POINTER_INFO_EXT};
+    importInfo.handleType = handleType;
+    importInfo.pHostPointer = ptr;
 
     VkMemoryAllocateInfo allocInfo{VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO};
-    allocInfo.allocationSize = memReqs.size;
-    allocInfo.memoryTypeIndex = findMemoryType(
-        ctx, memReqs.memoryTypeBits,
-        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
-            VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    allocInfo.pNext = &importInfo;
+    allocInfo.allocationSize = size;
+    allocInfo.memoryTypeIndex = typeIndex;
 
     VK_CHECK(vkAllocateMemory(ctx.device, &allocInfo, nullptr, &memory));
     VK_CHECK(vkBindBufferMemory(ctx.device, buffer, memory, 0));
@@ -187,7 +572,44 @@ void submitAndWait(const VkContext& ctx, VkCommandBuffer cmd) {
     VK_CHECK(vkQueueSubmit(ctx.computeQueue, 1, &submitInfo, fence));
     VK_CHECK(vkWaitForFences(ctx.device, 1, &fence, VK_TRUE, UINT64_MAX));
 
-    vkDestroyFence(ctx.device, fence, nullptr);
+    API_TRACE(vkDestroyFence(ctx.device, fence, nullptr));
+}
+
+void copyBuffer(const VkContext& ctx, VkCommandBuffer cmd, VkBuffer src,
+                VkBuffer dst, VkDeviceSize size) {
+    copyBuffer(ctx, cmd, src, dst, {VkBufferCopy{0, 0, size}});
+}
+
+void copyBuffer(const VkContext& ctx, VkCommandBuffer cmd, VkBuffer src,
+                VkBuffer dst, const std::vector<VkBufferCopy>& regions) {
+    VkCommandBufferBeginInfo beginInfo{
+        VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    VK_CHECK(vkBeginCommandBuffer(cmd, &beginInfo));
+
+    VkMemoryBarrier before{VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+    before.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    before.dstAccessMask =
+        VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+    API_TRACE(vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                   VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1,
+                                   &before, 0, nullptr, 0, nullptr));
+
+    API_TRACE(vkCmdCopyBuffer(cmd, src, dst,
+                              static_cast<uint32_t>(regions.size()),
+                              regions.data()));
+
+    VkMemoryBarrier after{VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+    after.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    after.dstAccessMask = VK_ACCESS_SHADER_READ_BIT |
+                          VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_HOST_READ_BIT;
+    API_TRACE(vkCmdPipelineBarrier(
+        cmd, VK_PIPELINE_STAGE_TRANSFER_BIT,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_HOST_BIT, 0,
+        1, &after, 0, nullptr, 0, nullptr));
+
+    VK_CHECK(vkEndCommandBuffer(cmd));
+    submitAndWait(ctx, cmd);
 }
 
 }  // namespace vkutil